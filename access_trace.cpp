@@ -0,0 +1,120 @@
+#include "access_trace.h"
+
+#include <cstring>
+
+/**
+ * Constructor. The reader starts closed.
+ */
+access_trace_reader::access_trace_reader() : file(nullptr), line(0), malformed(false)
+{
+}
+
+/**
+ * Destructor, closes the trace file.
+ */
+access_trace_reader::~access_trace_reader()
+{
+    close();
+}
+
+/**
+ * Opens a text access trace.
+ *
+ * @param file_name: The name of the trace file.
+ *
+ * @return: True if the file was opened, false otherwise.
+ */
+bool access_trace_reader::open(const char* file_name)
+{
+    close();
+    file = fopen(file_name, "r");
+    line = 0;
+    malformed = false;
+    return file != nullptr;
+}
+
+/**
+ * Reads the next request of the trace.
+ *
+ * @param access: Where to store the request.
+ *
+ * @return: True if a request was read, false at the end of the trace or on a malformed line (see is_malformed).
+ */
+bool access_trace_reader::next(trace_access* access)
+{
+    char buffer[TRACE_LINE_SIZE];
+
+    if (file == nullptr)
+        return false;
+
+    while (fgets(buffer, sizeof(buffer), file) != nullptr)
+    {
+        line++;
+
+        char op;
+        int address;
+        char value = '\0';
+        int fields = sscanf(buffer, " %c %d %c", &op, &address, &value);
+
+        // Skip empty lines and comments
+        if (fields <= 0 || op == '#')
+            continue;
+
+        if (fields < 2 || (op != TRACE_LOAD && op != TRACE_STORE) || (op == TRACE_STORE && fields < 3))
+        {
+            malformed = true;
+            return false;
+        }
+
+        memset(access, 0, sizeof(trace_access));
+        access->address = address;
+        access->op = op;
+        access->value = value;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @return: The number of the last line read, to point at a malformed line.
+ */
+long access_trace_reader::get_line() const
+{
+    return line;
+}
+
+/**
+ * @return: True if reading stopped on a malformed line rather than at the end of the trace.
+ */
+bool access_trace_reader::is_malformed() const
+{
+    return malformed;
+}
+
+/**
+ * Closes the trace file.
+ */
+void access_trace_reader::close()
+{
+    if (file != nullptr)
+        fclose(file);
+
+    file = nullptr;
+}
+
+/**
+ * Writes a request to a text access trace.
+ *
+ * @param file: The trace file.
+ * @param access: The request.
+ *
+ * @return: True if the request was written, false otherwise.
+ */
+bool write_access(FILE* file, const trace_access* access)
+{
+    if (access->op == TRACE_STORE)
+        return fprintf(file, "%c %d %c\n", TRACE_STORE, access->address, access->value) > 0;
+
+    return fprintf(file, "%c %d\n", TRACE_LOAD, access->address) > 0;
+}
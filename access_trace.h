@@ -0,0 +1,43 @@
+#ifndef EX4_ACCESS_TRACE_H
+#define EX4_ACCESS_TRACE_H
+
+// Required libraries and headers
+#include <cstdio>
+#include <cstdint>
+
+// Constants for access traces
+#define TRACE_LOAD 'L'   // A load request: "L <address>"
+#define TRACE_STORE 'S'  // A store request: "S <address> <value>"
+#define TRACE_LINE_SIZE 128 // Longest line of an access trace
+
+
+// A single load or store request, also the record of the binary form of a trace
+typedef struct trace_access
+{
+    int32_t address;  // The logical address
+    char op;          // TRACE_LOAD or TRACE_STORE
+    char value;       // The value to store, unused for loads
+    char padding[2];  // Keeps the record 8 bytes long
+} trace_access;
+
+
+// Streams the requests of a text access trace, one request per line. Empty lines and lines starting with '#' are skipped.
+class access_trace_reader {
+
+    FILE* file;  // The trace file
+    long line;   // Number of the last line read
+    bool malformed; // Did reading stop on a malformed line?
+
+public:
+    access_trace_reader();  // Constructor
+    ~access_trace_reader();  // Destructor
+    bool open(const char* file_name);  // Open a trace file
+    bool next(trace_access* access);  // Read the next request
+    long get_line() const;  // Number of the last line read
+    bool is_malformed() const;  // Did reading stop on a malformed line?
+    void close();  // Close the trace file
+};
+
+bool write_access(FILE* file, const trace_access* access);  // Write a request to a text access trace
+
+#endif
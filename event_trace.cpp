@@ -0,0 +1,182 @@
+#include "event_trace.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * Returns the name of an event type.
+ *
+ * @param type: The event type.
+ *
+ * @return: A constant string naming the event type.
+ */
+const char* trace_event_name(int type)
+{
+    switch (type)
+    {
+        case TRACE_HIT:
+            return "hit";
+        case TRACE_FAULT:
+            return "fault";
+        case TRACE_EVICT:
+            return "evict";
+        case TRACE_SWAP_OUT:
+            return "swap-out";
+        case TRACE_SWAP_IN:
+            return "swap-in";
+        case TRACE_PROMOTE:
+            return "promote";
+        case TRACE_DEMOTE:
+            return "demote";
+        case TRACE_SPLIT:
+            return "split";
+        case TRACE_COLLAPSE:
+            return "collapse";
+        default:
+            return "unknown";
+    }
+}
+
+/**
+ * Constructor. The trace starts closed.
+ */
+event_trace::event_trace() : ring(nullptr), capacity(0), head(0), tail(0), running(false), dropped(0), fd(-1)
+{
+}
+
+/**
+ * Destructor, stops the drainer and writes the remaining events.
+ */
+event_trace::~event_trace()
+{
+    close();
+}
+
+/**
+ * Creates (or truncates) the trace file, writes its header and starts the drainer thread.
+ * A trace that is already open is closed first.
+ *
+ * @param file_name: The name of the trace file.
+ * @param capacity: Number of events the ring buffer holds, rounded up to a power of two.
+ *
+ * @return: True if the trace was opened, false otherwise.
+ */
+bool event_trace::open(const char* file_name, size_t capacity)
+{
+    close();
+
+    if (file_name == nullptr || capacity == 0)
+        return false;
+
+    int trace_fd = ::open(file_name, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (trace_fd == -1)
+        return false;
+
+    trace_header header;
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    header.event_size = sizeof(trace_event);
+    header.dropped = 0;
+
+    if (write(trace_fd, &header, sizeof(header)) != (ssize_t) sizeof(header))
+    {
+        ::close(trace_fd);
+        return false;
+    }
+
+    // Round the capacity up to a power of two so positions can be masked
+    size_t rounded = 1;
+    while (rounded < capacity)
+        rounded <<= 1;
+
+    this->ring = new trace_event[rounded](); // Zeroed, so the padding written to the file is always 0
+    this->capacity = rounded;
+    this->head.store(0);
+    this->tail.store(0);
+    this->dropped.store(0);
+    this->fd = trace_fd;
+    this->running.store(true);
+    this->drainer = std::thread(&event_trace::drain_loop, this);
+
+    return true;
+}
+
+/**
+ * Stops the drainer thread, writes the events still in the ring buffer, records the number of dropped
+ * events in the header and closes the file.
+ */
+void event_trace::close()
+{
+    if (fd == -1)
+        return;
+
+    running.store(false);
+    drainer.join();
+    drain();
+
+    // Like failed event writes, a failed header update is not reported: tracing never fails the simulation
+    int64_t lost = dropped.load();
+    ssize_t written = pwrite(fd, &lost, sizeof(lost), offsetof(trace_header, dropped));
+    (void) written;
+
+    ::close(fd);
+    fd = -1;
+    delete[] ring;
+    ring = nullptr;
+    capacity = 0;
+}
+
+/**
+ * @return: The number of events lost because the ring buffer was full, since the trace was last opened.
+ */
+long event_trace::dropped_events() const
+{
+    return dropped.load(std::memory_order_relaxed);
+}
+
+/**
+ * Body of the drainer thread: writes pending events and sleeps while there are none.
+ */
+void event_trace::drain_loop()
+{
+    while (running.load(std::memory_order_acquire))
+        if (!drain())
+            std::this_thread::sleep_for(std::chrono::microseconds(TRACE_DRAIN_INTERVAL_US));
+}
+
+/**
+ * Writes all pending events to the file, with at most two writes (the ring buffer may wrap around).
+ *
+ * @return: True if any events were written, false if the ring buffer was empty or the write failed.
+ */
+bool event_trace::drain()
+{
+    size_t start = tail.load(std::memory_order_relaxed);
+    size_t end = head.load(std::memory_order_acquire);
+
+    if (start == end)
+        return false;
+
+    size_t position = start;
+    while (position != end)
+    {
+        size_t index = position & (capacity - 1);
+        size_t count = end - position;
+
+        if (index + count > capacity)
+            count = capacity - index;
+
+        ssize_t size = (ssize_t) (count * sizeof(trace_event));
+        if (write(fd, &ring[index], size) != size)
+            break;
+
+        position += count;
+    }
+
+    // Release the slots even if the write failed, so the producer never stalls
+    tail.store(end, std::memory_order_release);
+    return position == end;
+}
@@ -0,0 +1,121 @@
+#ifndef EX4_EVENT_TRACE_H
+#define EX4_EVENT_TRACE_H
+
+// Required libraries and headers
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+// Constants for the event trace
+#define TRACE_MAGIC "SIMTRACE"        // First bytes of every trace file
+#define TRACE_VERSION 3               // Version of the trace file format
+#define TRACE_DEFAULT_CAPACITY 65536  // Default number of events the ring buffer holds
+#define TRACE_DRAIN_INTERVAL_US 1000  // How long the drainer sleeps when the ring buffer is empty
+
+
+// Kinds of events recorded in the trace
+typedef enum trace_event_type
+{
+    TRACE_HIT = 0,   // The page was already in memory
+    TRACE_FAULT,     // The page was loaded into a frame
+    TRACE_EVICT,     // The page was removed from its frame
+    TRACE_SWAP_OUT,  // The page was written to the swap file
+    TRACE_SWAP_IN,   // The page was read from the swap file
+    TRACE_PROMOTE,   // The page was moved from the slow tier to the fast tier
+    TRACE_DEMOTE,    // The page was moved from the fast tier to the slow tier
+    TRACE_SPLIT,     // The huge page of the page was split back into base pages
+    TRACE_COLLAPSE,  // The resident base pages of a block were collapsed into a huge page
+    TRACE_EVENT_TYPE_COUNT
+} trace_event_type;
+
+// A single event, stored in the trace file exactly as in memory
+typedef struct trace_event
+{
+    int64_t timestamp;   // Simulation clock when the event happened
+    int32_t frame;       // Frame of the page, -1 if none (a slow tier may hold more frames than 16 bits count)
+    int16_t swap_index;  // Swap slot of the page, -1 if none
+    uint16_t page;       // Inner index of the page
+    uint8_t type;        // One of trace_event_type
+    uint8_t segment;     // Outer index of the page (text, data, bss, heap/stack)
+    uint8_t padding[6];  // Always 0, keeps the size a multiple of the timestamp's alignment
+} trace_event;
+
+// Header at the start of every trace file
+typedef struct trace_header
+{
+    char magic[8];        // TRACE_MAGIC, without the terminating null
+    uint32_t version;     // TRACE_VERSION
+    uint32_t event_size;  // sizeof(trace_event) of the writer
+    int64_t dropped;      // Events lost because the ring buffer was full, written when the trace is closed
+} trace_header;
+
+const char* trace_event_name(int type);  // Name of an event type
+
+
+// Lock-free single producer ring buffer of events, written to a file by a background thread
+class event_trace {
+
+    trace_event* ring;                 // The ring buffer, capacity is a power of two
+    size_t capacity;                   // Number of events the ring buffer holds
+    std::atomic<size_t> head;          // Next slot the producer writes
+    std::atomic<size_t> tail;          // Next slot the drainer reads
+    std::atomic<bool> running;         // Is the drainer thread still supposed to run?
+    std::atomic<long> dropped;         // Events lost because the ring buffer was full
+    std::thread drainer;               // Thread writing the ring buffer to the file
+    int fd;                            // File descriptor of the trace file, -1 when closed
+
+public:
+    event_trace();  // Constructor
+    ~event_trace();  // Destructor
+    bool open(const char* file_name, size_t capacity);  // Start tracing into a file
+    void close();  // Stop tracing, writing the remaining events
+
+    /**
+     * @return True if events are currently being recorded.
+     */
+    bool is_open() const
+    {
+        return fd != -1;
+    }
+
+    /**
+     * Appends an event to the ring buffer. Never blocks: if the ring buffer is full, the event is dropped
+     * and counted.
+     *
+     * @param type: The kind of event.
+     * @param timestamp: The simulation clock.
+     * @param segment: Outer index of the page.
+     * @param page: Inner index of the page.
+     * @param frame: Frame of the page, -1 if none.
+     * @param swap_index: Swap slot of the page, -1 if none.
+     */
+    void record(trace_event_type type, long timestamp, int segment, int page, int frame, int swap_index)
+    {
+        size_t position = head.load(std::memory_order_relaxed);
+
+        if (position - tail.load(std::memory_order_acquire) >= capacity)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        trace_event* event = &ring[position & (capacity - 1)];
+        event->timestamp = timestamp;
+        event->type = (uint8_t) type;
+        event->segment = (uint8_t) segment;
+        event->page = (uint16_t) page;
+        event->frame = (int32_t) frame;
+        event->swap_index = (int16_t) swap_index;
+
+        head.store(position + 1, std::memory_order_release);
+    }
+
+    long dropped_events() const;  // Number of events lost because the ring buffer was full
+
+private:
+    void drain_loop();  // Body of the drainer thread
+    bool drain();  // Write all pending events to the file
+};
+
+#endif
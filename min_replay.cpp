@@ -0,0 +1,72 @@
+#include "min_trace.h"
+
+
+/**
+ * Replays an access trace twice, once with the simulator's own (LRU) replacement and once with the optimal
+ * offline MIN (Belady) replacement, and reports the page faults of both.
+ *
+ * Usage: min_replay <trace file> <exe file> <swap file> <text size> <data size> <bss size> <heap/stack size>
+ *                   <page size>
+ *
+ * The simulator has a single memory tier here: with a slow tier, MIN would pick the victims of each tier
+ * on its own, which is not Belady's optimal replacement.
+ */
+int main(int argc, char* argv[])
+{
+    if (argc != 9)
+    {
+        fprintf(stderr, "Usage: %s <trace file> <exe file> <swap file> <text size> <data size> <bss size> "
+                        "<heap/stack size> <page size>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int text_size = atoi(argv[4]);
+    int data_size = atoi(argv[5]);
+    int bss_size = atoi(argv[6]);
+    int heap_stack_size = atoi(argv[7]);
+    int page_size = atoi(argv[8]);
+
+    min_trace trace;
+    if (!trace.prepare(argv[1], text_size, data_size, bss_size, heap_stack_size, page_size))
+    {
+        if (trace.get_bad_line() != 0)
+            fprintf(stderr, "ERR: malformed request at line %ld of %s\n", trace.get_bad_line(), argv[1]);
+        else
+            perror("ERR\n");
+        return EXIT_FAILURE;
+    }
+
+    sim_stats online, optimal;
+
+    // Each replay gets a fresh simulator, so both start from an empty memory and swap file
+    {
+        sim_mem mem(argv[2], argv[3], text_size, data_size, bss_size, heap_stack_size, page_size);
+        mem.set_error_log(nullptr, 0);
+        if (!trace.replay(&mem, false))
+        {
+            perror("ERR\n");
+            return EXIT_FAILURE;
+        }
+        online = mem.get_stats();
+    }
+
+    {
+        sim_mem mem(argv[2], argv[3], text_size, data_size, bss_size, heap_stack_size, page_size);
+        mem.set_error_log(nullptr, 0);
+        if (!trace.replay(&mem, true))
+        {
+            perror("ERR\n");
+            return EXIT_FAILURE;
+        }
+        optimal = mem.get_stats();
+    }
+
+    printf("Requests\t %ld\n", trace.size());
+    printf("Accesses\t %ld\n", online.accesses);
+    printf("LRU faults\t %ld\n", online.faults);
+    printf("MIN faults\t %ld\n", optimal.faults);
+    if (optimal.faults > 0)
+        printf("LRU / MIN\t %.3f\n", (double) online.faults / optimal.faults);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,266 @@
+#include "min_trace.h"
+
+/**
+ * Creates an unlinked temporary file in the current directory.
+ *
+ * @return: The file descriptor, or -1 on failure.
+ */
+static int open_temporary_file()
+{
+    char name[] = "min_trace_XXXXXX";
+    int fd = mkstemp(name);
+
+    if (fd != -1)
+        unlink(name);
+
+    return fd;
+}
+
+/**
+ * Finds the page a request reaches, following the checks of sim_mem::try_load/try_store.
+ *
+ * @param address: The logical address of the request.
+ * @param segment_pages: Number of pages in each segment.
+ * @param shift: log2 of the page size.
+ * @param outer: Where to store the outer index of the page.
+ *
+ * @return: The key of the page (address >> shift), or -1 if the address is illegal.
+ */
+static int get_page_key(int address, const int* segment_pages, int shift, int* outer)
+{
+    if (address < MIN_ADDRESS || address > MAX_ADDRESS)
+        return -1;
+
+    *outer = address >> SEGMENT_SHIFT;
+    if (((address & ((1 << SEGMENT_SHIFT) - 1)) >> shift) >= segment_pages[*outer])
+        return -1;
+
+    return address >> shift;
+}
+
+/**
+ * Constructor. The trace starts empty.
+ */
+min_trace::min_trace() : records_fd(-1), next_use_fd(-1), count(0), bad_line(0)
+{
+}
+
+/**
+ * Destructor, closes (and so deletes) the temporary files.
+ */
+min_trace::~min_trace()
+{
+    close();
+}
+
+/**
+ * Prepares a text access trace for replays.
+ *
+ * The requests are first copied forward into a binary file of fixed-size records. That file is then read
+ * backwards, one chunk at a time, keeping the index of the latest request seen for every page: this is the
+ * next use of the page for the request before it. Memory use is bounded by the chunk size and the number of
+ * pages, whatever the length of the trace.
+ *
+ * A request the simulator rejects is no use of its page: it gets no next use of its own, and is skipped
+ * when looking for the next use of the requests before it. This needs the segment sizes, and for the
+ * heap/stack the first store to every page (loads before it are rejected), found while copying.
+ *
+ * @param trace_file: The name of the text access trace.
+ * @param text_size: Size of the text segment.
+ * @param data_size: Size of the data segment.
+ * @param bss_size: Size of the BSS segment.
+ * @param heap_stack_size: Size of the heap/stack.
+ * @param page_size: Size of each page, requests to the same page share their next uses.
+ *
+ * @return: True if the trace was prepared, false otherwise (see get_bad_line for malformed traces).
+ */
+bool min_trace::prepare(const char* trace_file, int text_size, int data_size, int bss_size, int heap_stack_size, int page_size)
+{
+    close();
+    count = 0;
+    bad_line = 0;
+
+    access_trace_reader reader;
+    if (!reader.open(trace_file))
+        return false;
+
+    records_fd = open_temporary_file();
+    next_use_fd = open_temporary_file();
+    if (records_fd == -1 || next_use_fd == -1)
+        return false;
+
+    trace_access* records = new trace_access[MIN_CHUNK_SIZE];
+    long* next_uses = new long[MIN_CHUNK_SIZE];
+    long* page_next_use = new long[MIN_PAGE_KEYS];
+    long* first_store = new long[MIN_PAGE_KEYS];
+    int segment_pages[] = {text_size / page_size, data_size / page_size, bss_size / page_size, heap_stack_size / page_size};
+    bool success = true;
+
+    int shift = 0;
+    while ((1 << shift) < page_size)
+        shift++;
+
+    for (int i = 0; i < MIN_PAGE_KEYS; i++)
+    {
+        page_next_use[i] = LONG_MAX;
+        first_store[i] = LONG_MAX;
+    }
+
+    // Copy the requests into the binary file, noting the first store to every page
+    int used = 0;
+    while (success)
+    {
+        bool more = reader.next(&records[used]);
+        if (more)
+        {
+            int outer;
+            int key = get_page_key(records[used].address, segment_pages, shift, &outer);
+
+            if (key != -1 && records[used].op == TRACE_STORE && first_store[key] == LONG_MAX)
+                first_store[key] = count + used;
+
+            used++;
+        }
+
+        if (used == MIN_CHUNK_SIZE || (!more && used > 0))
+        {
+            ssize_t size = (ssize_t) (used * sizeof(trace_access));
+            success = pwrite(records_fd, records, size, (off_t) count * sizeof(trace_access)) == size;
+            count += used;
+            used = 0;
+        }
+
+        if (!more)
+            break;
+    }
+
+    // The reader stops early on a malformed line
+    if (reader.is_malformed())
+    {
+        bad_line = reader.get_line();
+        success = false;
+    }
+
+    // Walk the requests backwards to find the next use of every request's page
+    for (long end = count; end > 0 && success;)
+    {
+        long start = end > MIN_CHUNK_SIZE ? end - MIN_CHUNK_SIZE : 0;
+        ssize_t size = (ssize_t) ((end - start) * sizeof(trace_access));
+
+        if (pread(records_fd, records, size, (off_t) start * sizeof(trace_access)) != size)
+        {
+            success = false;
+            break;
+        }
+
+        for (long i = end - 1; i >= start; i--)
+        {
+            int outer;
+            int key = get_page_key(records[i - start].address, segment_pages, shift, &outer);
+            bool store = records[i - start].op == TRACE_STORE;
+
+            // Illegal addresses, stores to text and loads from heap/stack pages never stored to are rejected
+            if (key == -1 || (outer == 0 && store) || (outer == 3 && !store && first_store[key] > i))
+            {
+                next_uses[i - start] = LONG_MAX;
+                continue;
+            }
+
+            next_uses[i - start] = page_next_use[key];
+            page_next_use[key] = i;
+        }
+
+        size = (ssize_t) ((end - start) * sizeof(long));
+        success = pwrite(next_use_fd, next_uses, size, (off_t) start * sizeof(long)) == size;
+        end = start;
+    }
+
+    delete[] records;
+    delete[] next_uses;
+    delete[] page_next_use;
+    delete[] first_store;
+    return success;
+}
+
+/**
+ * Runs the requests of the trace through a simulator, in order.
+ *
+ * @param mem: The simulator.
+ * @param min: True to replay with the MIN (Belady) replacement policy, false to keep the simulator's own policy.
+ *             MIN is only optimal for a single tier: with a slow tier, each tier picks its victims on its own.
+ *
+ * @return: True if the whole trace was replayed, false on an I/O error.
+ */
+bool min_trace::replay(sim_mem* mem, bool min) const
+{
+    if (records_fd == -1 || next_use_fd == -1)
+        return false;
+
+    trace_access* records = new trace_access[MIN_CHUNK_SIZE];
+    long* next_uses = new long[MIN_CHUNK_SIZE];
+    bool success = true;
+
+    if (min)
+        mem->set_replacement_policy(REPLACE_MIN);
+
+    for (long start = 0; start < count && success; start += MIN_CHUNK_SIZE)
+    {
+        long length = count - start < MIN_CHUNK_SIZE ? count - start : MIN_CHUNK_SIZE;
+        ssize_t records_size = (ssize_t) (length * sizeof(trace_access));
+        ssize_t next_uses_size = (ssize_t) (length * sizeof(long));
+
+        if (pread(records_fd, records, records_size, (off_t) start * sizeof(trace_access)) != records_size ||
+            pread(next_use_fd, next_uses, next_uses_size, (off_t) start * sizeof(long)) != next_uses_size)
+        {
+            success = false;
+            break;
+        }
+
+        for (long i = 0; i < length; i++)
+        {
+            char value;
+
+            if (min)
+                mem->set_next_use(start + i, next_uses[i]);
+
+            if (records[i].op == TRACE_STORE)
+                mem->try_store(records[i].address, records[i].value);
+            else
+                mem->try_load(records[i].address, &value);
+        }
+    }
+
+    delete[] records;
+    delete[] next_uses;
+    return success;
+}
+
+/**
+ * @return: The number of requests in the trace.
+ */
+long min_trace::size() const
+{
+    return count;
+}
+
+/**
+ * @return: The line of the first malformed request of the last prepared trace, 0 if there was none.
+ */
+long min_trace::get_bad_line() const
+{
+    return bad_line;
+}
+
+/**
+ * Closes the temporary files.
+ */
+void min_trace::close()
+{
+    if (records_fd != -1)
+        ::close(records_fd);
+    if (next_use_fd != -1)
+        ::close(next_use_fd);
+
+    records_fd = -1;
+    next_use_fd = -1;
+}
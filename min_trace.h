@@ -0,0 +1,37 @@
+#ifndef EX4_MIN_TRACE_H
+#define EX4_MIN_TRACE_H
+
+// Required libraries and headers
+#include "sim_mem.h"
+#include "access_trace.h"
+
+// Constants for offline replays
+#define MIN_CHUNK_SIZE 65536 // Requests held in memory at once while preparing or replaying a trace
+#define MIN_PAGE_KEYS (MAX_ADDRESS + 1) // Most distinct pages a logical address space can have (1 byte pages)
+
+
+// An access trace prepared for offline replays: a binary copy of its requests and, for every request,
+// the index of the next request to the same page. Requests the simulator rejects (illegal addresses,
+// stores to text, loads from heap/stack pages never stored to) never reach a page, so they are no use
+// of it. Both live in unlinked temporary files and are processed in chunks, so traces much larger than
+// the memory can be used.
+class min_trace {
+
+    int records_fd;   // Binary copy of the requests (trace_access records)
+    int next_use_fd;  // Index of the next request to the same page, for every request (long)
+    long count;       // Number of requests in the trace
+    long bad_line;    // Line of the first malformed request, 0 if none
+
+public:
+    min_trace();  // Constructor
+    ~min_trace();  // Destructor
+    bool prepare(const char* trace_file, int text_size, int data_size, int bss_size, int heap_stack_size, int page_size);  // Read a text access trace and compute the next uses
+    bool replay(sim_mem* mem, bool min) const;  // Run the requests through a simulator
+    long size() const;  // Number of requests in the trace
+    long get_bad_line() const;  // Line of the first malformed request
+
+private:
+    void close();  // Close the temporary files
+};
+
+#endif
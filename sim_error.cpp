@@ -0,0 +1,178 @@
+#include "sim_error.h"
+
+#include <chrono>
+#include <cstring>
+
+/**
+ * Returns a short description of a result code.
+ *
+ * @param error: The result code.
+ *
+ * @return: A constant string describing the result code.
+ */
+const char* sim_error_name(sim_error error)
+{
+    switch (error)
+    {
+        case SIM_OK:
+            return "ok";
+        case SIM_ILLEGAL_ADDRESS:
+            return "illegal address";
+        case SIM_WRITE_TO_TEXT:
+            return "write to text";
+        case SIM_UNINITIALIZED_HEAP_READ:
+            return "uninitialized heap read";
+        case SIM_SWAP_FULL:
+            return "swap full";
+        case SIM_NO_FRAME:
+            return "no frame";
+        case SIM_IO_ERROR:
+            return "I/O error";
+        default:
+            return "unknown error";
+    }
+}
+
+/**
+ * Constructor. Messages go to stdout without a rate limit until set_stream is called.
+ */
+error_log::error_log()
+{
+    this->stream = stdout;
+    this->max_per_second = 0;
+    this->used = 0;
+    this->window_start = 0;
+    this->window_messages = 0;
+    this->suppressed = 0;
+
+    for (long &count: counts)
+        count = 0;
+}
+
+/**
+ * Destructor, hands the remaining messages to the stream.
+ */
+error_log::~error_log()
+{
+    report_suppressed();
+    flush();
+}
+
+/**
+ * Sets where messages are logged and how many of them are allowed per second.
+ * Buffered messages are flushed to the previous stream first.
+ *
+ * @param stream: The stream to log to, or nullptr to only count failures.
+ * @param max_per_second: Maximal number of messages per second, 0 for no limit.
+ */
+void error_log::set_stream(FILE* stream, int max_per_second)
+{
+    report_suppressed();
+    flush();
+    this->stream = stream;
+    this->max_per_second = max_per_second;
+    this->window_start = 0;
+    this->window_messages = 0;
+    this->suppressed = 0;
+}
+
+/**
+ * Counts a failure and, if logging is enabled and the rate limit allows it, appends a message to the buffer.
+ * No I/O is done unless the buffer is full.
+ *
+ * @param error: The failure to record.
+ * @param address: The logical address of the request that failed.
+ *
+ * @return: The given error, so callers can return the result of this function.
+ */
+sim_error error_log::record(sim_error error, int address)
+{
+    counts[error]++;
+
+    if (stream == nullptr)
+        return error;
+
+    if (max_per_second > 0)
+    {
+        long long now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+
+        // Start a new window, reporting how many messages the previous one dropped
+        if (now - window_start >= 1000000000LL)
+        {
+            window_start = now;
+            window_messages = 0;
+            report_suppressed();
+        }
+
+        if (window_messages >= max_per_second)
+        {
+            suppressed++;
+            return error;
+        }
+
+        window_messages++;
+    }
+
+    char message[64];
+    int length = snprintf(message, sizeof(message), "ERR %s (address %d)\n", sim_error_name(error), address);
+    append(message, length);
+
+    return error;
+}
+
+/**
+ * @param error: The kind of failure.
+ *
+ * @return: The number of failures of the given kind recorded so far.
+ */
+long error_log::count(sim_error error) const
+{
+    return counts[error];
+}
+
+/**
+ * Hands the buffered messages to the stream with a single write.
+ */
+void error_log::flush()
+{
+    if (used == 0)
+        return;
+
+    if (stream != nullptr)
+        fwrite(buffer, 1, used, stream);
+
+    used = 0;
+}
+
+/**
+ * Appends a message with the number of messages dropped by the rate limit, if there are any.
+ */
+void error_log::report_suppressed()
+{
+    if (suppressed == 0)
+        return;
+
+    char message[64];
+    int length = snprintf(message, sizeof(message), "ERR %ld messages suppressed\n", suppressed);
+    append(message, length);
+    suppressed = 0;
+}
+
+/**
+ * Appends a message to the buffer, flushing it first if the message does not fit.
+ *
+ * @param message: The message to append.
+ * @param length: The length of the message.
+ */
+void error_log::append(const char* message, int length)
+{
+    if (length <= 0)
+        return;
+
+    if (used + length > ERROR_LOG_BUFFER_SIZE)
+        flush();
+
+    memcpy(buffer + used, message, length);
+    used += length;
+}
@@ -0,0 +1,52 @@
+#ifndef EX4_SIM_ERROR_H
+#define EX4_SIM_ERROR_H
+
+// Required libraries and headers
+#include <cstdio>
+
+// Constants for the error log
+#define ERROR_LOG_BUFFER_SIZE 4096 // Bytes of messages buffered before they are handed to the stream
+
+
+// Result of a load/store request and of the internal paging operations
+typedef enum sim_error
+{
+    SIM_OK = 0,                   // The request succeeded
+    SIM_ILLEGAL_ADDRESS,          // The address is outside the logical address space or its segment
+    SIM_WRITE_TO_TEXT,            // Store to a read-only text page
+    SIM_UNINITIALIZED_HEAP_READ,  // Load from a heap/stack page that was never stored to
+    SIM_SWAP_FULL,                // No free slot left in the swap file
+    SIM_NO_FRAME,                 // No frame could be freed for the page
+    SIM_IO_ERROR,                 // Reading or writing the executable or swap file failed
+    SIM_ERROR_COUNT               // Number of result codes, not a result by itself
+} sim_error;
+
+const char* sim_error_name(sim_error error);  // Short human-readable description of a result code
+
+
+// Counts failures and optionally logs them through a buffered, rate-limited stream
+class error_log {
+
+    FILE* stream;                          // Where messages go, nullptr to only count
+    int max_per_second;                    // Messages allowed per second, 0 for no limit
+    long counts[SIM_ERROR_COUNT];          // Number of failures of each kind
+    char buffer[ERROR_LOG_BUFFER_SIZE];    // Messages not yet handed to the stream
+    size_t used;                           // Bytes used in the buffer
+    long long window_start;                // Start of the current rate limit window (ns)
+    int window_messages;                   // Messages logged in the current window
+    long suppressed;                       // Messages dropped by the rate limit, not yet reported
+
+public:
+    error_log();  // Constructor
+    ~error_log();  // Destructor
+    void set_stream(FILE* stream, int max_per_second);  // Set where and how often messages are logged
+    sim_error record(sim_error error, int address);  // Count a failure and log it
+    long count(sim_error error) const;  // Number of failures of the given kind
+    void flush();  // Hand the buffered messages to the stream
+
+private:
+    void report_suppressed();  // Log how many messages the rate limit dropped
+    void append(const char* message, int length);  // Append a message to the buffer
+};
+
+#endif
@@ -2,6 +2,25 @@
 
 char main_memory[MEMORY_SIZE];
 
+/**
+ * Creates the parameters of an adaptive frame allocation, with the default window and fault rates.
+ *
+ * @param min_frames: The least fast tier frames the pages may use.
+ * @param max_frames: The most fast tier frames the pages may use.
+ *
+ * @return: The parameters.
+ */
+frame_allocation make_frame_allocation(int min_frames, int max_frames)
+{
+    frame_allocation allocation;
+    allocation.min_frames = min_frames;
+    allocation.max_frames = max_frames;
+    allocation.window = FRAME_WINDOW;
+    allocation.high_fault_rate = HIGH_FAULT_RATE;
+    allocation.low_fault_rate = LOW_FAULT_RATE;
+    return allocation;
+}
+
 /**
  * This constructor opens provided executable and swap files, initializes memory,
  * page table and related arrays. It also sets up the swap file and calculates
@@ -14,10 +33,10 @@ char main_memory[MEMORY_SIZE];
  * @param data_size: Size of the data segment.
  * @param bss_size: Size of the BSS segment.
  * @param heap_stack_size: Size of the heap/stack.
- * @param num_of_pages: Number of pages in the memory.
  * @param page_size: Size of each page in the memory.
+ * @param slow_memory_size: Size of the slow memory tier behind main_memory, 0 for a single tier.
  */
-sim_mem::sim_mem(char exe_file_name[], char swap_file_name[], int text_size, int data_size, int bss_size, int heap_stack_size, int page_size)
+sim_mem::sim_mem(char exe_file_name[], char swap_file_name[], int text_size, int data_size, int bss_size, int heap_stack_size, int page_size, int slow_memory_size)
 {
     // Checking if the executable file name is provided
     if (exe_file_name == nullptr)
@@ -59,17 +78,56 @@ sim_mem::sim_mem(char exe_file_name[], char swap_file_name[], int text_size, int
         element = '0';
 
     // Storing the passed arguments into instance variables
-    this->swap_size = (data_size + bss_size + heap_stack_size) / page_size;
+    // The swap file is a log of clusters: one spare cluster on top of what the pages need keeps it writable
+    this->swap_clusters = ((data_size + bss_size + heap_stack_size) / page_size + SWAP_CLUSTER_SIZE - 1) / SWAP_CLUSTER_SIZE + 1;
+    this->swap_size = swap_clusters * SWAP_CLUSTER_SIZE;
     this->page_size = page_size;
     this->heap_stack_size = heap_stack_size;
     this->bss_size = bss_size;
     this->data_size = data_size;
     this->text_size = text_size;
     this->inner_table_size = std::log2(page_size);
-    this->frames_status = new bool[MEMORY_SIZE / page_size];
+    this->fast_frames = MEMORY_SIZE / page_size;
+    this->slow_frames = slow_memory_size / page_size;
+    this->slow_memory = slow_frames > 0 ? new char[slow_frames * page_size] : nullptr;
+    this->frames_status = new bool[fast_frames + slow_frames];
     this->swap_status = new bool[swap_size];
+    this->swap_owner = new page_descriptor* [swap_size];
+    this->swap_batch = new char[SWAP_CLUSTER_SIZE * page_size];
+    this->batch_outer = new int[SWAP_CLUSTER_SIZE];
+    this->batch_inner = new int[SWAP_CLUSTER_SIZE];
+    this->batch_count = 0;
+    this->swap_readahead = new char[SWAP_CLUSTER_SIZE * page_size];
+    this->readahead_cluster = -1;
     this->clock = 0;
-    this->frames_clock = new int[MEMORY_SIZE / page_size];
+    this->frames_clock = new long[fast_frames + slow_frames];
+    this->frames_hits = new int[fast_frames + slow_frames];
+    this->frames_next_use = new long[fast_frames + slow_frames];
+    this->policy = REPLACE_LRU;
+    this->next_use = 0;
+    this->request_index = 0;
+    this->stats = sim_stats();
+    this->tier_latency[FAST_TIER] = FAST_TIER_LATENCY;
+    this->tier_latency[SLOW_TIER] = SLOW_TIER_LATENCY;
+    this->fault_latency = PAGE_FAULT_LATENCY;
+    this->migration_latency = MIGRATION_LATENCY;
+    this->adaptive = false;
+    this->allocation = make_frame_allocation(1, fast_frames);
+    this->frame_quota = fast_frames;
+    this->window_accesses = 0;
+    this->window_faults = 0;
+    this->huge_table = new huge_descriptor* [OUTER_TABLE_SIZE];
+
+    // No segment has huge pages until enable_huge_pages
+    for (int i = 0; i < OUTER_TABLE_SIZE; i++)
+    {
+        huge_pages[i] = 0;
+        huge_table[i] = nullptr;
+    }
+
+    // Initializing the slow memory with 0s
+    for (int i = 0; i < slow_frames * page_size; i++)
+        slow_memory[i] = '0';
 
     // Initializing the swap file with 0s
     char value = '0';
@@ -82,13 +140,18 @@ sim_mem::sim_mem(char exe_file_name[], char swap_file_name[], int text_size, int
 
     // Initializing swap_status array with true values
     for (int i = 0; i < swap_size; i++)
+    {
         swap_status[i] = true;
+        swap_owner[i] = nullptr;
+    }
 
-    // Initializing frames_status and frames_clock arrays
-    for (int i = 0; i < MEMORY_SIZE / page_size; i++)
+    // Initializing frames_status, frames_clock and frames_hits arrays
+    for (int i = 0; i < fast_frames + slow_frames; i++)
     {
         frames_status[i] = true;
         frames_clock[i] = -1;
+        frames_hits[i] = 0;
+        frames_next_use[i] = 0;
     }
 
     // Initializing page table
@@ -108,15 +171,32 @@ sim_mem::sim_mem(char exe_file_name[], char swap_file_name[], int text_size, int
 /**
  * Fetches a byte from the specified address in the simulated memory.
  *
- * The function processes a logical address, converting it into physical terms. Based on the page type
- * (text, data, BSS, heap/stack), the page is loaded from the relevant file. If loading is not
- * possible, an error is signaled and a null character is returned.
+ * Failures are counted and logged through the error log, see try_load.
  *
  * @param address: The logical address to load from.
  *
  * @return The byte from the given address, or '\0' in case of an error.
  */
 char sim_mem::load(int address)
+{
+    char value = '\0';
+    try_load(address, &value);
+    return value;
+}
+
+/**
+ * Fetches a byte from the specified address in the simulated memory.
+ *
+ * The function processes a logical address, converting it into physical terms. Based on the page type
+ * (text, data, BSS, heap/stack), the page is loaded from the relevant file. Failures are counted and
+ * logged through the error log, and the value is left untouched.
+ *
+ * @param address: The logical address to load from.
+ * @param value: Where to store the loaded byte.
+ *
+ * @return SIM_OK on success, otherwise the reason of the failure.
+ */
+sim_error sim_mem::try_load(int address, char* value)
 {
     int outer, inner, offset;
 
@@ -126,60 +206,72 @@ char sim_mem::load(int address)
     // Get the table indices and offset for this address
     get_physical_address(logical_address, &outer, &inner, &offset);
 
-    // If the address is not legal, print an error and return null character
+    // If the address is not legal, report an error
     if (!is_legal(outer, inner) || address < MIN_ADDRESS || address > MAX_ADDRESS)
+        return errors.record(SIM_ILLEGAL_ADDRESS, address);
+
+    page_descriptor* p = &page_table[outer][inner];
+
+    // If the page is part of a huge page, translate it through the huge page descriptor
+    if (huge_pages[outer] != 0 && huge_table[outer][inner / huge_pages[outer]].valid)
     {
-        std::cout << "ERR" << std::endl;
-        return '\0';
+        int frame = access_huge_page(outer, inner);
+        if (trace.is_open())
+            trace.record(TRACE_HIT, clock, outer, inner, frame, p->swap_index);
+
+        *value = frame_data(frame)[offset];
+        if (adaptive)
+            adapt_frame_quota();
+        return SIM_OK;
     }
 
     // If the page is already in memory, update the frames clock and return the memory content
-    if (page_table[outer][inner].valid)
+    if (p->valid)
     {
         update_frames_clock(outer, inner);
-        return get_memory_content(outer, inner, offset);
+        record_hit(outer, inner);
+        if (trace.is_open())
+            trace.record(TRACE_HIT, clock, outer, inner, p->frame, p->swap_index);
+
+        *value = get_memory_content(outer, inner, offset);
+        if (adaptive)
+            adapt_frame_quota();
+        return SIM_OK;
     }
 
-    // If the page is a text page, load it into memory from the program file
-    if (outer == 0)
-    {
-        if (load_to_memory(&page_table[outer][inner], program_fd, page_size * inner))
-            return get_memory_content(outer, inner, offset);
+    sim_error result;
 
-        return '\0';
-    }
+    // If the segment has huge pages, map the whole huge page of the page with this one fault
+    if (can_map_huge(outer, inner))
+        result = load_huge_page(outer, inner, false);
 
-    // If the page is dirty, load it from the swap file
-    if (page_table[outer][inner].dirty)
-    {
-        if (load_to_memory(&page_table[outer][inner], swapfile_fd, -1))
-            return get_memory_content(outer, inner, offset);
+    // If the page is a text page, load it into memory from the program file
+    else if (outer == 0)
+        result = load_to_memory(outer, inner, program_fd, page_size * inner);
 
-        return '\0';
-    }
+    // If the page is dirty, load it from the swap file
+    else if (p->dirty)
+        result = load_to_memory(outer, inner, swapfile_fd, -1);
 
-    // If the page is a heap/stack page, print an error and return null character (can not load such page for the first time - it has to be created via store)
-    if (outer == 3)
-    {
-        std::cout << "ERR" << std::endl;
-        return '\0';
-    }
+    // If the page is a heap/stack page, report an error (can not load such page for the first time - it has to be created via store)
+    else if (outer == 3)
+        result = SIM_UNINITIALIZED_HEAP_READ;
 
     // If the page is a data page, load it from the program file
-    if (outer == 1)
-    {
-        if (load_to_memory(&page_table[outer][inner], program_fd, text_size + (inner * page_size)))
-            return get_memory_content(outer, inner, offset);
-
-        return '\0';
-    }
+    else if (outer == 1)
+        result = load_to_memory(outer, inner, program_fd, text_size + (inner * page_size));
 
     // If the page is a BSS page, load it from the program file
-    if (load_to_memory(&page_table[outer][inner], program_fd, text_size + data_size + (inner * page_size)))
-        return get_memory_content(outer, inner, offset);
+    else
+        result = load_to_memory(outer, inner, program_fd, text_size + data_size + (inner * page_size));
 
-    // If none of the above conditions are met, return null character
-    return '\0';
+    if (result != SIM_OK)
+        return errors.record(result, address);
+
+    *value = get_memory_content(outer, inner, offset);
+    if (adaptive)
+        adapt_frame_quota();
+    return SIM_OK;
 }
 
 
@@ -197,7 +289,7 @@ char sim_mem::load(int address)
  */
 char sim_mem::get_memory_content(int outer, int inner, int offset)
 {
-    return main_memory[page_table[outer][inner].frame * page_size + offset];
+    return frame_data(page_table[outer][inner].frame)[offset];
 }
 
 /**
@@ -213,65 +305,468 @@ char sim_mem::get_memory_content(int outer, int inner, int offset)
 void sim_mem::update_frames_clock(int outer, int inner)
 {
     frames_clock[page_table[outer][inner].frame] = clock;
+    frames_next_use[page_table[outer][inner].frame] = next_use;
     clock++;
 }
 
 
+/**
+ * Writes a given value into memory at a specified address.
+ *
+ * Failures are counted and logged through the error log, see try_store.
+ *
+ * @param address: The logical memory address to store the value at.
+ * @param value: The value to store in memory.
+ */
+void sim_mem::store(int address, char value)
+{
+    try_store(address, value);
+}
+
 /**
  * Writes a given value into memory at a specified address.
  *
  * This function translates the provided logical address into a physical one, and
  * attempts to store the value at the translated address. If the page isn't in memory,
  * it loads the page before storing the value. Text pages are read-only and cannot be written to.
+ * Failures are counted and logged through the error log.
  *
  * @param address: The logical memory address to store the value at.
  * @param value: The value to store in memory.
+ *
+ * @return SIM_OK on success, otherwise the reason of the failure.
  */
-void sim_mem::store(int address, char value)
+sim_error sim_mem::try_store(int address, char value)
 {
     // Convert logical address to physical address components
     int outer, inner, offset;
     long logical_address = get_logical_address(address);
     get_physical_address(logical_address, &outer, &inner, &offset);
 
-    // Check if the address is valid or if it's a text page
-    if (!is_legal(outer, inner) || outer == 0 || address < MIN_ADDRESS || address > MAX_ADDRESS)
+    // Check if the address is valid
+    if (!is_legal(outer, inner) || address < MIN_ADDRESS || address > MAX_ADDRESS)
+        return errors.record(SIM_ILLEGAL_ADDRESS, address);
+
+    // Text pages are read-only
+    if (outer == 0)
+        return errors.record(SIM_WRITE_TO_TEXT, address);
+
+    page_descriptor* p = &page_table[outer][inner];
+
+    // If the page is part of a huge page, translate it through the huge page descriptor
+    if (huge_pages[outer] != 0 && huge_table[outer][inner / huge_pages[outer]].valid)
     {
-        std::cout << "ERR" << std::endl;
-        return;
+        int frame = access_huge_page(outer, inner);
+        if (trace.is_open())
+            trace.record(TRACE_HIT, clock, outer, inner, frame, p->swap_index);
+
+        // Only the stored base page becomes dirty, the rest of the huge page keeps its swap state
+        frame_data(frame)[offset] = value;
+        p->dirty = true;
+        p->modified = true;
+        if (adaptive)
+            adapt_frame_quota();
+        return SIM_OK;
     }
 
     // If the page is in memory
-    if (page_table[outer][inner].valid)
+    if (p->valid)
     {
         // Update the access time and write the value to memory
         update_frames_clock(outer, inner);
+        record_hit(outer, inner);
+        if (trace.is_open())
+            trace.record(TRACE_HIT, clock, outer, inner, p->frame, p->swap_index);
+
         write_to_memory(outer, inner, offset, value);
-        return;
+        if (adaptive)
+            adapt_frame_quota();
+        return SIM_OK;
     }
 
+    sim_error result;
 
-    // If the page is in the swap file
-    if (page_table[outer][inner].dirty)
+    // If the segment has huge pages, map the whole huge page of the page with this one fault
+    if (can_map_huge(outer, inner))
+        result = load_huge_page(outer, inner, true);
+
+    // If the page is in the swap file, load it into memory
+    else if (p->dirty)
+        result = load_to_memory(outer, inner, swapfile_fd, -1);
+
+    // If it's a data page, load the page from the program file into memory
+    else if (outer == 1)
+        result = load_to_memory(outer, inner, program_fd, text_size + (inner * page_size));
+
+    // If it's a heap_stake or bss page, initialize a new page
+    else
+        result = load_to_memory(outer, inner, NEW_PAGE, -1);
+
+    if (result != SIM_OK)
+        return errors.record(result, address);
+
+    write_to_memory(outer, inner, offset, value);
+    if (adaptive)
+        adapt_frame_quota();
+    return SIM_OK;
+}
+
+/**
+ * Starts recording paging events (hits, faults, evictions, swap-outs and swap-ins) into a binary trace file.
+ * Events go to a lock-free ring buffer and are written to the file by a background thread; when the ring
+ * buffer is full, events are dropped rather than slowing the simulation down. Use trace_decoder to read the file.
+ *
+ * @param file_name: The name of the trace file, created or truncated.
+ * @param capacity: Number of events the ring buffer holds.
+ *
+ * @return True if tracing started, false otherwise.
+ */
+bool sim_mem::enable_event_trace(const char* file_name, size_t capacity)
+{
+    return trace.open(file_name, capacity);
+}
+
+/**
+ * Stops recording paging events, writing the remaining events to the trace file.
+ */
+void sim_mem::disable_event_trace()
+{
+    trace.close();
+}
+
+/**
+ * @return The number of paging events lost because the ring buffer was full, since the trace was last
+ * enabled. The count is also written to the trace file when tracing stops.
+ */
+long sim_mem::dropped_trace_events() const
+{
+    return trace.dropped_events();
+}
+
+/**
+ * Sets the latency cost model used to estimate the average memory access time.
+ *
+ * @param fast: Cost of an access to the fast tier (ns).
+ * @param slow: Cost of an access to the slow tier (ns).
+ * @param fault: Cost of loading a page on a fault (ns).
+ * @param migration: Cost of moving a page between the tiers (ns).
+ */
+void sim_mem::set_tier_latencies(double fast, double slow, double fault, double migration)
+{
+    this->tier_latency[FAST_TIER] = fast;
+    this->tier_latency[SLOW_TIER] = slow;
+    this->fault_latency = fault;
+    this->migration_latency = migration;
+}
+
+/**
+ * Sets how the page to evict is chosen.
+ *
+ * @param policy: REPLACE_LRU (the default), or REPLACE_MIN for offline replays that call set_next_use before every access.
+ */
+void sim_mem::set_replacement_policy(replacement_policy policy)
+{
+    this->policy = policy;
+}
+
+/**
+ * Sets the index in the trace of the next load/store and when its page is used again, for REPLACE_MIN.
+ * The next use is kept with the page's frame until the page is accessed again.
+ *
+ * @param index: Index in the trace of the next access.
+ * @param next_use: Index in the trace of the next access to the same page, LONG_MAX if there is none.
+ */
+void sim_mem::set_next_use(long index, long next_use)
+{
+    this->request_index = index;
+    this->next_use = next_use;
+}
+
+/**
+ * Adapts the number of fast tier frames the pages may use to their page fault frequency. At the end of every
+ * window of accesses, the frame quota grows by one frame if the fault rate of the window was above
+ * high_fault_rate, and shrinks by one frame if it was below low_fault_rate - but never below the working set,
+ * the pages accessed during the window. Pages over a shrunk quota are reclaimed right away: demoted to the
+ * slow tier if there is one, evicted otherwise.
+ *
+ * @param allocation: The bounds of the quota, the window length and the fault rates.
+ *
+ * @return True if the allocation was enabled, false if its parameters are not valid for this memory.
+ */
+bool sim_mem::enable_adaptive_frames(const frame_allocation& allocation)
+{
+    if (allocation.min_frames < 1 || allocation.max_frames > fast_frames || allocation.min_frames > allocation.max_frames ||
+        allocation.window < 1 || allocation.low_fault_rate > allocation.high_fault_rate)
+        return false;
+
+    this->adaptive = true;
+    this->allocation = allocation;
+    this->window_accesses = stats.accesses;
+    this->window_faults = stats.faults;
+
+    // Start from the frames in use, within the bounds
+    int used = get_used_frames(FAST_TIER);
+    frame_quota = used < allocation.min_frames ? allocation.min_frames : used;
+    if (frame_quota > allocation.max_frames)
+        frame_quota = allocation.max_frames;
+
+    reclaim_frames();
+    return true;
+}
+
+/**
+ * Stops adapting the frame quota, the pages may use every fast tier frame again.
+ */
+void sim_mem::disable_adaptive_frames()
+{
+    adaptive = false;
+    frame_quota = fast_frames;
+}
+
+/**
+ * @return The number of fast tier frames the pages may use.
+ */
+int sim_mem::get_frame_quota() const
+{
+    return frame_quota;
+}
+
+/**
+ * Maps a segment with huge pages: aligned blocks of base pages that a single fault loads together, into
+ * contiguous frames of the fast tier, and that a single huge page descriptor maps. Loads and stores to a
+ * huge page are translated through its descriptor, and it ages as one unit: every access refreshes all of
+ * its frames, and it is evicted or demoted as a whole. The base page descriptors stay filled in (like the
+ * page table deposited with a transparent huge page) and keep their own dirty and swap state, so a store
+ * only makes its own base page dirty, and a huge page is split back into base pages without any I/O when a
+ * single one of its pages has to move (a promotion trading frames with it, a collapse). The blocks of a
+ * segment whose pages are not all out of memory are not mapped with a huge page by a fault,
+ * collapse_huge_pages maps them once they are all in memory.
+ *
+ * The heap/stack can not have huge pages: its pages only exist once they are stored to.
+ *
+ * @param segment: The outer index of the segment: 0 (text), 1 (data) or 2 (bss).
+ * @param pages: Base pages in a huge page, a power of two of at least 2 and at most the fast tier frames.
+ *
+ * @return True if the segment has huge pages of this size, false if the parameters are not valid.
+ */
+bool sim_mem::enable_huge_pages(int segment, int pages)
+{
+    int page_split[] = {text_size, data_size, bss_size, heap_stack_size};
+
+    if (segment < 0 || segment >= OUTER_TABLE_SIZE - 1 || pages < 2 || (pages & (pages - 1)) != 0 ||
+        pages > fast_frames || page_split[segment] / page_size < pages)
+        return false;
+
+    disable_huge_pages(segment);
+
+    int blocks = (page_split[segment] / page_size + pages - 1) / pages;
+    huge_pages[segment] = pages;
+    huge_table[segment] = new huge_descriptor[blocks];
+
+    for (int i = 0; i < blocks; i++)
     {
-        // Load the page into memory and then write the value
-        if (load_to_memory(&page_table[outer][inner], swapfile_fd, -1))
-            write_to_memory(outer, inner, offset, value);
+        huge_table[segment][i].valid = false;
+        huge_table[segment][i].frame = -1;
+    }
+
+    return true;
+}
+
+/**
+ * Maps a segment with base pages only, splitting its huge pages.
+ *
+ * @param segment: The outer index of the segment.
+ */
+void sim_mem::disable_huge_pages(int segment)
+{
+    if (segment < 0 || segment >= OUTER_TABLE_SIZE || huge_pages[segment] == 0)
         return;
+
+    int page_split[] = {text_size, data_size, bss_size, heap_stack_size};
+    int blocks = (page_split[segment] / page_size + huge_pages[segment] - 1) / huge_pages[segment];
+
+    for (int i = 0; i < blocks; i++)
+        if (huge_table[segment][i].valid)
+            split_huge_page(segment, i * huge_pages[segment]);
+
+    delete[] huge_table[segment];
+    huge_table[segment] = nullptr;
+    huge_pages[segment] = 0;
+}
+
+/**
+ * Collapses blocks of base pages into huge pages: every block of a segment with huge pages whose pages are
+ * all in the fast tier is moved into contiguous aligned frames, and mapped by its huge page descriptor. The
+ * pages in the way trade frames with the pages of the block. This is the work of a background daemon
+ * (like khugepaged), meant to be called periodically between accesses.
+ *
+ * @return The number of blocks collapsed into huge pages.
+ */
+int sim_mem::collapse_huge_pages()
+{
+    int page_split[] = {text_size, data_size, bss_size, heap_stack_size};
+    int collapsed = 0;
+
+    for (int outer = 0; outer < OUTER_TABLE_SIZE; outer++)
+    {
+        int pages = huge_pages[outer];
+        if (pages == 0)
+            continue;
+
+        int blocks = page_split[outer] / page_size / pages;
+        for (int block = 0; block < blocks; block++)
+        {
+            int first_page = block * pages;
+            bool resident = !huge_table[outer][block].valid;
+
+            for (int i = 0; i < pages && resident; i++)
+                resident = page_table[outer][first_page + i].valid && page_table[outer][first_page + i].frame < fast_frames;
+
+            if (!resident)
+                continue;
+
+            // Choose the aligned frames that need the fewest moves, without touching another huge page
+            int best = -1, best_moves = INT_MAX;
+            for (int start = 0; start + pages <= fast_frames; start += pages)
+            {
+                int moves = 0;
+                bool usable = true;
+
+                for (int i = 0; i < pages; i++)
+                {
+                    int owner_outer, owner_inner;
+                    if (!frames_status[start + i] && get_frame_owner(start + i, &owner_outer, &owner_inner) &&
+                        page_table[owner_outer][owner_inner].huge)
+                        usable = false;
+
+                    if (page_table[outer][first_page + i].frame != start + i)
+                        moves++;
+                }
+
+                if (usable && moves < best_moves)
+                {
+                    best = start;
+                    best_moves = moves;
+                }
+            }
+
+            if (best == -1)
+                continue;
+
+            for (int i = 0; i < pages; i++)
+            {
+                int target = best + i;
+                int owner_outer, owner_inner;
+
+                if (page_table[outer][first_page + i].frame == target)
+                    continue;
+
+                if (frames_status[target])
+                    move_page(outer, first_page + i, target);
+                else if (get_frame_owner(target, &owner_outer, &owner_inner))
+                    exchange_pages(outer, first_page + i, owner_outer, owner_inner);
+            }
+
+            huge_table[outer][block].valid = true;
+            huge_table[outer][block].frame = best;
+            for (int i = 0; i < pages; i++)
+                page_table[outer][first_page + i].huge = true;
+
+            // From now on the huge page ages as one unit, as recently used as its most recent page
+            long newest = frames_clock[best];
+            long soonest = frames_next_use[best];
+            for (int i = best; i < best + pages; i++)
+            {
+                newest = frames_clock[i] > newest ? frames_clock[i] : newest;
+                soonest = frames_next_use[i] < soonest ? frames_next_use[i] : soonest;
+            }
+            for (int i = best; i < best + pages; i++)
+            {
+                frames_clock[i] = newest;
+                frames_next_use[i] = soonest;
+            }
+
+            stats.collapses++;
+            collapsed++;
+
+            if (trace.is_open())
+                trace.record(TRACE_COLLAPSE, clock, outer, first_page, best, page_table[outer][first_page].swap_index);
+        }
     }
 
-    // If it's a data page
-    if (outer == 1)
+    return collapsed;
+}
+
+/**
+ * @return The counters of the accesses since the simulator was created.
+ */
+sim_stats sim_mem::get_stats() const
+{
+    return stats;
+}
+
+/**
+ * Estimates the average memory access time of the workload so far, using the latency cost model:
+ * every access costs its tier's latency, faults and page migrations add their own cost on top.
+ *
+ * @return The estimated average memory access time (ns), 0 if there were no accesses.
+ */
+double sim_mem::get_average_access_time() const
+{
+    if (stats.accesses == 0)
+        return 0;
+
+    return stats.total_latency / stats.accesses;
+}
+
+/**
+ * Prints the counters of the accesses and the estimated average memory access time.
+ */
+void sim_mem::print_stats()
+{
+    errors.flush();
+    printf("\n Memory statistics\n");
+    printf("Accesses\t %ld\n", stats.accesses);
+    printf("Fast tier hits\t %ld\n", stats.fast_hits);
+    printf("Slow tier hits\t %ld\n", stats.slow_hits);
+    printf("Page faults\t %ld\n", stats.faults);
+    printf("Promotions\t %ld\n", stats.promotions);
+    printf("Demotions\t %ld\n", stats.demotions);
+    printf("Evictions\t %ld\n", stats.evictions);
+    if (stats.huge_faults > 0 || stats.collapses > 0)
     {
-        // Load the page from the program file into memory and then write the value
-        if (load_to_memory(&page_table[outer][inner], program_fd, text_size + (inner * page_size)))
-            write_to_memory(outer, inner, offset, value);
-        return;
+        printf("Huge faults\t %ld\n", stats.huge_faults);
+        printf("Splits\t\t %ld\n", stats.splits);
+        printf("Collapses\t %ld\n", stats.collapses);
+    }
+    if (adaptive)
+    {
+        printf("Frame quota\t %d\n", frame_quota);
+        printf("Reclaims\t %ld\n", stats.reclaims);
     }
+    printf("AMAT (ns)\t %.1f\n", get_average_access_time());
+}
 
-    // If it's a heap_stake or bss page, initialize a new page
-    if (load_to_memory(&page_table[outer][inner], NEW_PAGE, -1))
-        write_to_memory(outer, inner, offset, value);
+/**
+ * Sets where failures of load/store requests are logged and how many messages are allowed per second.
+ * Failures are counted either way.
+ *
+ * @param stream: The stream to log to, or nullptr to only count failures.
+ * @param max_per_second: Maximal number of messages per second, 0 for no limit.
+ */
+void sim_mem::set_error_log(FILE* stream, int max_per_second)
+{
+    errors.set_stream(stream, max_per_second);
+}
+
+/**
+ * @param error: The kind of failure.
+ *
+ * @return The number of failures of the given kind since the simulator was created.
+ */
+long sim_mem::error_count(sim_error error) const
+{
+    return errors.count(error);
 }
 
 
@@ -279,7 +774,7 @@ void sim_mem::store(int address, char value)
  * Writes a value to a specific location in the physical memory.
  *
  * This function receives the physical address in the form of outer, inner, and offset, and then writes
- * the provided value into the specified location. It also marks the related page as dirty.
+ * the provided value into the specified location. It also marks the related page as dirty and modified.
  *
  * @param outer: The outer index of the page table.
  * @param inner: The inner index of the page table.
@@ -289,10 +784,13 @@ void sim_mem::store(int address, char value)
 void sim_mem::write_to_memory(int outer, int inner, int offset, char value)
 {
     // Write the provided value to the specified physical memory location
-    main_memory[page_table[outer][inner].frame * page_size + offset] = value;
+    frame_data(page_table[outer][inner].frame)[offset] = value;
 
     // Mark the page as dirty, indicating it has been written to and may need to be written back to disk
     page_table[outer][inner].dirty = true;
+
+    // Any copy of the page in the swap file is now stale
+    page_table[outer][inner].modified = true;
 }
 
 
@@ -332,7 +830,9 @@ void sim_mem::init_page(page_descriptor* pd)
     pd->valid = false;       // Set the valid flag to false, indicating the page is not yet in memory.
     pd->frame = -1;         // Initialize the frame number to -1, meaning it is not yet assigned.
     pd->dirty = false;      // Set the dirty flag to false, indicating no modifications have been made.
+    pd->modified = false;   // Set the modified flag to false, there is no copy in the swap file to be stale.
     pd->swap_index = -1;    // Initialize the swap index to -1, meaning it is not yet assigned.
+    pd->huge = false;       // Set the huge flag to false, the page is mapped on its own.
 }
 
 
@@ -342,21 +842,33 @@ void sim_mem::init_page(page_descriptor* pd)
 void sim_mem::print_memory()
 {
     int i;
+    errors.flush();
     printf("\n Physical memory\n");
     for (i = 0; i < MEMORY_SIZE; i++)
     {
         printf("[%c]\n", main_memory[i]);
     }
+
+    if (slow_frames == 0)
+        return;
+
+    printf("\n Slow memory\n");
+    for (i = 0; i < slow_frames * page_size; i++)
+    {
+        printf("[%c]\n", slow_memory[i]);
+    }
 }
 
 
 /**
- * Prints the current state of the swap file.
+ * Prints the current state of the swap file, followed by the evicted pages still waiting in the swap batch.
+ * Nothing is written: the batch is shown as it is, so printing never changes where pages end up.
  */
 void sim_mem::print_swap()
 {
     char* str = (char*) malloc(this->page_size * sizeof(char));
     int i;
+    errors.flush();
     printf("\n Swap memory\n");
     lseek(swapfile_fd, 0, SEEK_SET); // go to the start of the file
     while (read(swapfile_fd, str, this->page_size) == this->page_size)
@@ -369,6 +881,19 @@ void sim_mem::print_swap()
     }
 
     free(str);
+
+    if (batch_count == 0)
+        return;
+
+    printf("\n Swap batch\n");
+    for (int j = 0; j < batch_count; j++)
+    {
+        for (i = 0; i < page_size; i++)
+        {
+            printf("%d - [%c]\t", i, swap_batch[j * page_size + i]);
+        }
+        printf("\n");
+    }
 }
 
 /**
@@ -377,6 +902,7 @@ void sim_mem::print_swap()
 void sim_mem::print_page_table()
 {
     int i;
+    errors.flush();
     printf("Valid\t Dirty\t Frame\t Swap index\n");
     for (i = 0; i < text_size / page_size; i++)
     {
@@ -427,12 +953,24 @@ sim_mem::~sim_mem()
     close(program_fd);
     delete[] frames_status;
     delete[] swap_status;
+    delete[] swap_owner;
+    delete[] swap_batch;
+    delete[] batch_outer;
+    delete[] batch_inner;
+    delete[] swap_readahead;
     delete[] frames_clock;
+    delete[] frames_hits;
+    delete[] frames_next_use;
+    delete[] slow_memory;
 
     for (int i = 0; i < OUTER_TABLE_SIZE; i++)
+    {
         delete[] page_table[i];
+        delete[] huge_table[i];
+    }
 
     delete[] page_table;
+    delete[] huge_table;
 }
 
 
@@ -496,7 +1034,7 @@ void sim_mem::get_physical_address(long address, int* outer, int* inner, int* of
  * @param location: The location in the file from where data needs to be read.
  * @param amount: The number of bytes to read.
  *
- * @return: A pointer to a buffer containing the data read, or null if an error occurred.
+ * @return: A pointer to a buffer containing the data read, or null if an error occurred (including end of file).
  */
 char* sim_mem::read_from_file(int fd, int location, int amount)
 {
@@ -505,23 +1043,16 @@ char* sim_mem::read_from_file(int fd, int location, int amount)
     // Reposition the file offset to the specified location.
     if (lseek(fd, location, SEEK_SET) == -1)
     {
-        perror("ERR\n");
+        delete[] buffer; // Free the buffer if there's an error.
         return nullptr; // Return null if there's an error.
     }
 
     // Read the specified amount of data into the buffer.
     ssize_t bytes_read = read(fd, buffer, amount);
 
-    // Check if the read operation was successful.
-    if (bytes_read == -1)
-    {
-        perror("ERR\n");
-        delete[] buffer; // Free the buffer if there's an error.
-        return nullptr; // Return null if there's an error.
-    }
-    else if (bytes_read == 0) // Check if we've reached the end of the file.
+    // Check if the read operation was successful, or if we've reached the end of the file.
+    if (bytes_read <= 0)
     {
-        std::cout << "ERR" << std::endl;
         delete[] buffer; // Free the buffer if there's an error.
         return nullptr; // Return null if there's an error.
     }
@@ -547,10 +1078,7 @@ bool sim_mem::write_to_file(int fd, off_t location, const char* data, size_t siz
 
     // Check if the write operation was successful.
     if (bytes_written == -1)
-    {
-        perror("ERR\n");
         return false; // Return false if there was an error.
-    }
 
     return true; // Return true if the data was successfully written.
 }
@@ -559,40 +1087,78 @@ bool sim_mem::write_to_file(int fd, off_t location, const char* data, size_t siz
 /**
  * Loads content into memory from either the swap file, the program file, or initializes a new page.
  *
- * @param p: Pointer to the page descriptor.
+ * @param outer: The outer index of the page table.
+ * @param inner: The inner index of the page table.
  * @param fd: The file descriptor, which determines the source of the data to be loaded.
  * @param location: The location in the file to read from.
  *
- * @return: True if the operation is successful, false otherwise.
+ * @return: SIM_OK if the operation is successful, otherwise the reason of the failure.
  */
-bool sim_mem::load_to_memory(page_descriptor* p, int fd, int location)
+sim_error sim_mem::load_to_memory(int outer, int inner, int fd, int location)
 {
+    page_descriptor* p = &page_table[outer][inner];
     // Find the first available memory space location.
-    int memory_location = get_memory_space();
-    char* data;
+    int memory_location = get_memory_space(FAST_TIER);
 
-    // If no memory space is available.
-    if (memory_location == -1)
+    // If no memory space is available (a shrunk frame quota may take more than one page out).
+    while (memory_location == -1)
     {
-        if (!clear_memory_page()) // If failed to clear a page from the memory.
-        {
-            std::cout << "ERR" << std::endl;
-            return false;
-        }
-        memory_location = get_memory_space(); // Try to get available memory space again.
+        // Move the coldest page of the fast tier down to the slow tier, or out of memory if there is no slow tier
+        sim_error result = slow_frames > 0 ? demote_page() : clear_memory_page();
+        if (result != SIM_OK) // If failed to clear a page from the memory.
+            return result;
+
+        memory_location = get_memory_space(FAST_TIER); // Try to get available memory space again.
     }
 
+    sim_error result = fill_frame(outer, inner, memory_location, fd, location);
+    if (result != SIM_OK)
+        return result;
+
+    clock++;
+
+    // The access that caused the fault is served from the fast tier once the page is loaded
+    stats.faults++;
+    stats.accesses++;
+    stats.total_latency += fault_latency + tier_latency[FAST_TIER];
+
+    if (trace.is_open())
+        trace.record(TRACE_FAULT, clock, outer, inner, memory_location, p->swap_index);
+
+    return SIM_OK;
+}
+
+/**
+ * Loads a page into a free frame and maps it there. The frame gets the current clock as its access time,
+ * advancing the clock is left to the caller.
+ *
+ * @param outer: The outer index of the page table.
+ * @param inner: The inner index of the page table.
+ * @param frame: The free frame.
+ * @param fd: The file to load from: program_fd, swapfile_fd or NEW_PAGE for a page of '0's.
+ * @param location: The location in the program file to read from.
+ *
+ * @return: SIM_OK if the operation is successful, otherwise the reason of the failure.
+ */
+sim_error sim_mem::fill_frame(int outer, int inner, int frame, int fd, int location)
+{
+    page_descriptor* p = &page_table[outer][inner];
+    char* data;
+
     // If loading from swap file.
     if (fd == swapfile_fd)
     {
-        data = read_from_file(fd, p->swap_index * page_size, page_size);
+        data = new char[page_size];
 
-        if (data == nullptr)
-            return false;
+        if (trace.is_open())
+            trace.record(TRACE_SWAP_IN, clock, outer, inner, frame, p->swap_index);
 
-        // Update swap status and reset page's swap index.
-        swap_status[p->swap_index] = true;
-        p->swap_index = -1;
+        sim_error result = read_swap_page(p, data);
+        if (result != SIM_OK)
+        {
+            delete[] data;
+            return result;
+        }
     }
         // If loading from program file.
     else if (fd == program_fd)
@@ -600,7 +1166,7 @@ bool sim_mem::load_to_memory(page_descriptor* p, int fd, int location)
         data = read_from_file(fd, location, page_size);
 
         if (data == nullptr)
-            return false;
+            return SIM_IO_ERROR;
     }
         // If loading a new page.
     else if (fd == NEW_PAGE)
@@ -609,48 +1175,631 @@ bool sim_mem::load_to_memory(page_descriptor* p, int fd, int location)
         for (int i = 0; i < page_size; i++)
             data[i] = '0';
     }
+        // Unknown source.
+    else
+        return SIM_IO_ERROR;
 
     // Copy the data into the memory.
-    for (int i = 0; i < page_size; i++)
-        main_memory[i + (memory_location * page_size)] = data[i];
+    memcpy(frame_data(frame), data, page_size);
 
     // Set the page's new attributes.
-    (*p).frame = memory_location;
+    (*p).frame = frame;
     (*p).valid = true;
 
     // Update the frame's clock for LRU policy.
-    frames_clock[memory_location] = clock;
-    clock++;
+    frames_clock[frame] = clock;
+    frames_next_use[frame] = next_use;
 
     // Update the frame's availability status.
     frames_status[(*p).frame] = false;
+    frames_hits[frame] = 0;
 
     delete[] data;
+    return SIM_OK;
+}
+
+/**
+ * Checks if a fault on a page may map its whole huge page: the segment must have huge pages, the block of
+ * the page must be a whole block with none of its pages in memory, and it must fit in the frame quota.
+ *
+ * @param outer: The outer index of the page table.
+ * @param inner: The inner index of the page table.
+ *
+ * @return True if the fault may map the huge page, false if it loads the base page only.
+ */
+bool sim_mem::can_map_huge(int outer, int inner) const
+{
+    int pages = huge_pages[outer];
+    if (pages == 0 || pages > frame_quota)
+        return false;
+
+    int page_split[] = {text_size, data_size, bss_size, heap_stack_size};
+    int first_page = inner / pages * pages;
+
+    // The pages after the last whole block are always base pages
+    if (first_page + pages > page_split[outer] / page_size)
+        return false;
+
+    for (int i = first_page; i < first_page + pages; i++)
+        if (page_table[outer][i].valid)
+            return false;
+
     return true;
 }
 
 /**
- * Finds the first available space in the swap file.
+ * Maps the huge page of a page with one fault. The aligned frames of the fast tier that hold the fewest
+ * pages are freed (demoting or evicting their pages, and whole huge pages for frames of a huge page), and
+ * every base page of the block is loaded into its frame, from where try_load/try_store would load it.
  *
- * @return: The index of the available space, or -1 if no space is available.
+ * @param outer: The outer index of the page table.
+ * @param inner: The inner index of the page that faulted.
+ * @param store: True if the fault is for a store, false for a load.
+ *
+ * @return: SIM_OK if the operation is successful, otherwise the reason of the failure.
  */
-int sim_mem::get_swap_space() const
+sim_error sim_mem::load_huge_page(int outer, int inner, bool store)
 {
-    for (int i = 0; i < swap_size; i++)
-        if (swap_status[i])
-            return i;
+    int pages = huge_pages[outer];
+    int block = inner / pages;
+    int first_page = block * pages;
+    int best = -1, best_cost = INT_MAX;
+
+    // Choose the aligned frames that cost the least to free, a frame of another huge page frees all of it
+    for (int start = 0; start + pages <= fast_frames; start += pages)
+    {
+        int cost = 0;
+
+        for (int i = start; i < start + pages; i++)
+        {
+            int owner_outer, owner_inner;
+            if (!frames_status[i] && get_frame_owner(i, &owner_outer, &owner_inner))
+                cost += page_table[owner_outer][owner_inner].huge ? pages : 1;
+        }
+
+        if (cost < best_cost)
+        {
+            best = start;
+            best_cost = cost;
+        }
+    }
+
+    for (int i = best; i < best + pages; i++)
+    {
+        if (frames_status[i])
+            continue;
+
+        sim_error result = slow_frames > 0 ? demote_frame(i) : evict_frame(i);
+        if (result != SIM_OK)
+            return result;
+    }
+
+    // The other pages and the huge page together must fit in the frame quota
+    while (get_used_frames(FAST_TIER) + pages > frame_quota)
+    {
+        sim_error result = slow_frames > 0 ? demote_page() : clear_memory_page();
+        if (result != SIM_OK)
+            return result;
+    }
+
+    // A failure leaves the pages loaded so far mapped as base pages
+    for (int i = 0; i < pages; i++)
+    {
+        int fd, location;
+        get_page_source(outer, first_page + i, store && first_page + i == inner, &fd, &location);
+
+        sim_error result = fill_frame(outer, first_page + i, best + i, fd, location);
+        if (result != SIM_OK)
+            return result;
+    }
+
+    huge_table[outer][block].valid = true;
+    huge_table[outer][block].frame = best;
+    for (int i = 0; i < pages; i++)
+        page_table[outer][first_page + i].huge = true;
+
+    clock++;
+
+    // One fault for the whole huge page, the access is served from the fast tier
+    stats.faults++;
+    stats.huge_faults++;
+    stats.accesses++;
+    stats.total_latency += fault_latency + tier_latency[FAST_TIER];
+
+    if (trace.is_open())
+        trace.record(TRACE_FAULT, clock, outer, inner, page_table[outer][inner].frame, page_table[outer][inner].swap_index);
+
+    return SIM_OK;
+}
+
+/**
+ * Splits the huge page of a page back into base pages. The base page descriptors already map the frames,
+ * so only the huge page descriptor is dropped.
+ *
+ * @param outer: The outer index of the page table.
+ * @param inner: The inner index of any page of the huge page.
+ */
+void sim_mem::split_huge_page(int outer, int inner)
+{
+    unmap_huge_page(outer, inner);
+    stats.splits++;
+
+    if (trace.is_open())
+        trace.record(TRACE_SPLIT, clock, outer, inner, page_table[outer][inner].frame, page_table[outer][inner].swap_index);
+}
+
+/**
+ * Drops the huge page descriptor of a page's block: its base pages stay where they are, mapped on their own.
+ *
+ * @param outer: The outer index of the page table.
+ * @param inner: The inner index of any page of the huge page.
+ */
+void sim_mem::unmap_huge_page(int outer, int inner)
+{
+    int pages = huge_pages[outer];
+    int block = inner / pages;
+
+    huge_table[outer][block].valid = false;
+    huge_table[outer][block].frame = -1;
+    for (int i = block * pages; i < (block + 1) * pages; i++)
+        page_table[outer][i].huge = false;
+}
+
+/**
+ * Takes a whole huge page out of the fast tier: every base page is evicted, or demoted to the slow tier
+ * (which only holds base pages). This is not a split, the huge page leaves memory as one unit.
+ *
+ * @param outer: The outer index of the page table.
+ * @param inner: The inner index of any page of the huge page.
+ * @param demote: True to demote the pages, false to evict them.
+ *
+ * @return SIM_OK if all the pages were taken out, otherwise the reason of the failure.
+ */
+sim_error sim_mem::release_huge_page(int outer, int inner, bool demote)
+{
+    int pages = huge_pages[outer];
+    int first_page = inner / pages * pages;
+
+    unmap_huge_page(outer, inner);
+
+    for (int i = first_page; i < first_page + pages; i++)
+    {
+        int frame = page_table[outer][i].frame;
+        sim_error result = demote ? demote_frame(frame) : evict_frame(frame);
+        if (result != SIM_OK)
+            return result;
+    }
+
+    return SIM_OK;
+}
+
+/**
+ * Accounts an access to a page of a huge page, translating it through the huge page descriptor. The huge
+ * page ages as one unit: all of its frames get the current access time.
+ *
+ * @param outer: The outer index of the page table.
+ * @param inner: The inner index of the page table.
+ *
+ * @return The frame of the page.
+ */
+int sim_mem::access_huge_page(int outer, int inner)
+{
+    int pages = huge_pages[outer];
+    huge_descriptor* h = &huge_table[outer][inner / pages];
+
+    for (int i = h->frame; i < h->frame + pages; i++)
+    {
+        frames_clock[i] = clock;
+        frames_next_use[i] = next_use;
+    }
+    clock++;
+
+    record_hit(outer, inner);
+    return h->frame + inner % pages;
+}
+
+/**
+ * Finds where a page that is not in memory is loaded from, following the same rules as try_load/try_store:
+ * dirty pages from the swap file, text and data pages from the program file, bss pages from the program
+ * file on a load and as a new page on a store, heap/stack pages as a new page.
+ *
+ * @param outer: The outer index of the page table.
+ * @param inner: The inner index of the page table.
+ * @param store: True if the page is loaded for a store, false for a load.
+ * @param fd: Where to store the file to load from: program_fd, swapfile_fd or NEW_PAGE.
+ * @param location: Where to store the location in the program file.
+ */
+void sim_mem::get_page_source(int outer, int inner, bool store, int* fd, int* location) const
+{
+    *fd = program_fd;
+    *location = -1;
+
+    if (page_table[outer][inner].dirty)
+        *fd = swapfile_fd;
+    else if (outer == 0)
+        *location = page_size * inner;
+    else if (outer == 1)
+        *location = text_size + (inner * page_size);
+    else if (outer == 2 && !store)
+        *location = text_size + data_size + (inner * page_size);
+    else
+        *fd = NEW_PAGE;
+}
+
+/**
+ * Reads the content of a dirty page that is not in memory, either from the swap batch (if it was evicted
+ * but not written yet) or from its slot in the swap file. Swap file reads go through the readahead buffer:
+ * the whole cluster of the slot is read at once, so faults on its neighbours need no I/O.
+ *
+ * @param p: Pointer to the page descriptor.
+ * @param data: Where to copy the content of the page (page_size bytes).
+ *
+ * @return: SIM_OK if the operation is successful, otherwise the reason of the failure.
+ */
+sim_error sim_mem::read_swap_page(page_descriptor* p, char* data)
+{
+    // Not written yet - take the page out of the swap batch
+    if (p->swap_index == -1)
+    {
+        for (int i = 0; i < batch_count; i++)
+        {
+            if (&page_table[batch_outer[i]][batch_inner[i]] != p)
+                continue;
+
+            memcpy(data, swap_batch + i * page_size, page_size);
+
+            // Move the last page of the batch into the freed place
+            batch_count--;
+            memcpy(swap_batch + i * page_size, swap_batch + batch_count * page_size, page_size);
+            batch_outer[i] = batch_outer[batch_count];
+            batch_inner[i] = batch_inner[batch_count];
+
+            // There is no copy in the swap file, the next eviction has to write the page
+            p->modified = true;
+            return SIM_OK;
+        }
+
+        return SIM_IO_ERROR;
+    }
+
+    int cluster = p->swap_index / SWAP_CLUSTER_SIZE;
+    if (readahead_cluster != cluster)
+    {
+        ssize_t size = (ssize_t) SWAP_CLUSTER_SIZE * page_size;
+        if (pread(swapfile_fd, swap_readahead, size, (off_t) cluster * size) != size)
+        {
+            readahead_cluster = -1;
+            return SIM_IO_ERROR;
+        }
+        readahead_cluster = cluster;
+    }
+
+    memcpy(data, swap_readahead + (p->swap_index % SWAP_CLUSTER_SIZE) * page_size, page_size);
+
+    // Keep the swap slot tied to the page: as long as the page is not modified,
+    // the copy in the swap file stays valid and evicting the page needs no write.
+    p->modified = false;
+    return SIM_OK;
+}
+
+/**
+ * Makes sure the swap batch can take one more page: a batch left full by a failed write is written first.
+ *
+ * @return: SIM_OK if the batch has room, otherwise the reason of the failure.
+ */
+sim_error sim_mem::make_batch_room()
+{
+    if (batch_count < SWAP_CLUSTER_SIZE)
+        return SIM_OK;
+
+    sim_error result = flush_swap_batch();
+    if (batch_count == SWAP_CLUSTER_SIZE)
+        return result != SIM_OK ? result : SIM_IO_ERROR;
+
+    return SIM_OK;
+}
+
+/**
+ * Adds a page evicted from memory to the swap batch. Pages are not written one by one: when the batch
+ * holds a full cluster, it is written to the swap file at once (see flush_swap_batch).
+ *
+ * If the batch has no room, the page is left untouched. Once staged, the page's content is safe in the
+ * batch even if writing the full batch then fails: the write is retried by the next swap-out.
+ *
+ * @param outer: The outer index of the page table.
+ * @param inner: The inner index of the page table.
+ * @param frame: The frame holding the page.
+ *
+ * @return: SIM_OK if the page was staged and the batch written if full, otherwise the reason of the failure.
+ */
+sim_error sim_mem::stage_swap_out(int outer, int inner, int frame)
+{
+    page_descriptor* p = &page_table[outer][inner];
+
+    sim_error room = make_batch_room();
+    if (room != SIM_OK)
+        return room;
+
+    // The swap file is a log, a modified page is never rewritten in place: its old copy is simply dropped
+    if (p->swap_index != -1)
+    {
+        release_swap_slot(p->swap_index);
+        p->swap_index = -1;
+    }
+
+    memcpy(swap_batch + batch_count * page_size, frame_data(frame), page_size);
+    batch_outer[batch_count] = outer;
+    batch_inner[batch_count] = inner;
+    batch_count++;
+
+    if (batch_count == SWAP_CLUSTER_SIZE)
+        return flush_swap_batch();
+
+    return SIM_OK;
+}
+
+/**
+ * Writes the swap batch to the swap file.
+ *
+ * The pages are sorted by their logical address and appended to the swap cluster with the most free slots
+ * (an empty one whenever possible), so neighbours in the address space end up next to each other and
+ * readahead is effective. Every run of consecutive slots is written with a single pwritev.
+ * If no empty cluster is left afterwards, the swap file is compacted.
+ *
+ * @return: SIM_OK if the operation is successful, otherwise the reason of the failure.
+ */
+sim_error sim_mem::flush_swap_batch()
+{
+    if (batch_count == 0)
+        return SIM_OK;
+
+    // Sort the batch by logical address
+    int order[SWAP_CLUSTER_SIZE];
+    for (int i = 0; i < batch_count; i++)
+    {
+        int j = i;
+        while (j > 0 && (batch_outer[order[j - 1]] > batch_outer[i] ||
+                         (batch_outer[order[j - 1]] == batch_outer[i] && batch_inner[order[j - 1]] > batch_inner[i])))
+        {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    sim_error result = SIM_OK;
+    int next = 0;
+
+    while (next < batch_count && result == SIM_OK)
+    {
+        int cluster = get_swap_cluster(true, -1);
+        if (cluster == -1)
+        {
+            result = SIM_SWAP_FULL;
+            break;
+        }
+
+        // Assign the free slots of the cluster, in order, to the next pages of the batch
+        int slots[SWAP_CLUSTER_SIZE];
+        int pages[SWAP_CLUSTER_SIZE];
+        int count = 0;
+        for (int slot = cluster * SWAP_CLUSTER_SIZE; slot < (cluster + 1) * SWAP_CLUSTER_SIZE && next < batch_count; slot++)
+        {
+            if (!swap_status[slot])
+                continue;
+
+            slots[count] = slot;
+            pages[count] = order[next++];
+            count++;
+        }
+
+        // Write each run of consecutive slots with a single system call
+        for (int start = 0; start < count && result == SIM_OK;)
+        {
+            struct iovec iov[SWAP_CLUSTER_SIZE];
+            int length = 0;
+            do
+            {
+                iov[length].iov_base = swap_batch + pages[start + length] * page_size;
+                iov[length].iov_len = page_size;
+                length++;
+            } while (start + length < count && slots[start + length] == slots[start] + length);
+
+            ssize_t size = (ssize_t) length * page_size;
+            if (pwritev(swapfile_fd, iov, length, (off_t) slots[start] * page_size) != size)
+            {
+                result = SIM_IO_ERROR;
+                break;
+            }
+
+            for (int i = start; i < start + length; i++)
+            {
+                page_descriptor* p = &page_table[batch_outer[pages[i]]][batch_inner[pages[i]]];
+                p->swap_index = slots[i];
+                p->modified = false; // The swap file now holds the latest content
+                swap_status[slots[i]] = false; // Mark the swap location as occupied
+                swap_owner[slots[i]] = p;
+
+                if (trace.is_open())
+                    trace.record(TRACE_SWAP_OUT, clock, batch_outer[pages[i]], batch_inner[pages[i]], -1, slots[i]);
+
+                batch_outer[pages[i]] = -1; // Written, to be removed from the batch
+            }
+
+            start += length;
+        }
+
+        if (readahead_cluster == cluster)
+            readahead_cluster = -1;
+    }
+
+    // Remove the written pages from the batch
+    int kept = 0;
+    for (int i = 0; i < batch_count; i++)
+    {
+        if (batch_outer[i] == -1)
+            continue;
+
+        if (kept != i)
+        {
+            memcpy(swap_batch + kept * page_size, swap_batch + i * page_size, page_size);
+            batch_outer[kept] = batch_outer[i];
+            batch_inner[kept] = batch_inner[i];
+        }
+        kept++;
+    }
+    batch_count = kept;
+
+    if (result == SIM_OK && get_free_swap_clusters() == 0)
+        result = compact_swap();
+
+    return result;
+}
+
+/**
+ * Reclaims fragmented swap clusters until at least one cluster is empty, so the next batch can be written
+ * sequentially. The live pages of the cluster with the fewest of them are moved into the holes of the
+ * fullest clusters. Runs automatically when a flush leaves no empty cluster, and may be called while the
+ * simulation is idle to keep fault handling free of compaction work.
+ *
+ * @return: SIM_OK if the operation is successful, otherwise the reason of the failure.
+ */
+sim_error sim_mem::compact_swap()
+{
+    while (get_free_swap_clusters() == 0)
+    {
+        // The sparsest cluster - one with a free slot exists, since the swap file has a spare cluster
+        int victim = get_swap_cluster(true, -1);
+        if (victim == -1)
+            return SIM_SWAP_FULL;
+
+        ssize_t size = (ssize_t) SWAP_CLUSTER_SIZE * page_size;
+        if (readahead_cluster != victim)
+        {
+            if (pread(swapfile_fd, swap_readahead, size, (off_t) victim * size) != size)
+            {
+                readahead_cluster = -1;
+                return SIM_IO_ERROR;
+            }
+            readahead_cluster = victim;
+        }
 
-    return -1;
+        for (int slot = victim * SWAP_CLUSTER_SIZE; slot < (victim + 1) * SWAP_CLUSTER_SIZE; slot++)
+        {
+            if (swap_status[slot])
+                continue;
+
+            int target = get_swap_cluster(false, victim);
+            if (target == -1)
+                return SIM_SWAP_FULL;
+
+            int target_slot = target * SWAP_CLUSTER_SIZE;
+            while (!swap_status[target_slot])
+                target_slot++;
+
+            char* data = swap_readahead + (slot - victim * SWAP_CLUSTER_SIZE) * page_size;
+            if (!write_to_file(swapfile_fd, (off_t) target_slot * page_size, data, page_size))
+                return SIM_IO_ERROR;
+
+            page_descriptor* owner = swap_owner[slot];
+            owner->swap_index = target_slot;
+            swap_status[target_slot] = false;
+            swap_owner[target_slot] = owner;
+            release_swap_slot(slot);
+        }
+
+        readahead_cluster = -1;
+    }
+
+    return SIM_OK;
 }
 
 /**
- * Finds the first available space in the main memory.
+ * Finds a swap cluster with available space.
+ *
+ * @param most_free: True for the cluster with the most free slots, false for the one with the fewest (but at least one).
+ * @param exclude: A cluster to skip, or -1.
+ *
+ * @return: The index of the cluster, or -1 if no cluster has a free slot.
+ */
+int sim_mem::get_swap_cluster(bool most_free, int exclude) const
+{
+    int best = -1;
+    int best_free = 0;
+
+    for (int cluster = 0; cluster < swap_clusters; cluster++)
+    {
+        if (cluster == exclude)
+            continue;
+
+        int free_slots = 0;
+        for (int slot = cluster * SWAP_CLUSTER_SIZE; slot < (cluster + 1) * SWAP_CLUSTER_SIZE; slot++)
+            if (swap_status[slot])
+                free_slots++;
+
+        if (free_slots == 0)
+            continue;
+
+        if (best == -1 || (most_free ? free_slots > best_free : free_slots < best_free))
+        {
+            best = cluster;
+            best_free = free_slots;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * Counts the swap clusters that hold no page.
+ *
+ * @return: The number of empty clusters.
+ */
+int sim_mem::get_free_swap_clusters() const
+{
+    int count = 0;
+
+    for (int cluster = 0; cluster < swap_clusters; cluster++)
+    {
+        bool empty = true;
+        for (int slot = cluster * SWAP_CLUSTER_SIZE; slot < (cluster + 1) * SWAP_CLUSTER_SIZE && empty; slot++)
+            empty = swap_status[slot];
+
+        if (empty)
+            count++;
+    }
+
+    return count;
+}
+
+/**
+ * Frees a slot of the swap file.
+ *
+ * @param slot: The slot to free.
+ */
+void sim_mem::release_swap_slot(int slot)
+{
+    swap_status[slot] = true;
+    swap_owner[slot] = nullptr;
+}
+
+/**
+ * Finds the first available space in a tier of the memory.
+ *
+ * @param tier: FAST_TIER or SLOW_TIER.
  *
  * @return The index of the available space, or -1 if no space is available.
  */
-int sim_mem::get_memory_space()
+int sim_mem::get_memory_space(int tier)
 {
-    for (int i = 0; i < MEMORY_SIZE / page_size; i++)
+    int first = tier == FAST_TIER ? 0 : fast_frames;
+    int last = tier == FAST_TIER ? fast_frames : fast_frames + slow_frames;
+
+    // The pages may not use more fast tier frames than their quota
+    if (tier == FAST_TIER && frame_quota < fast_frames && get_used_frames(FAST_TIER) >= frame_quota)
+        return -1;
+
+    for (int i = first; i < last; i++)
         if (frames_status[i])
             return i;
 
@@ -658,81 +1807,443 @@ int sim_mem::get_memory_space()
 }
 
 /**
- * Clears a page from the main memory using the LRU (Least Recently Used) algorithm.
+ * Counts the frames holding a page in a tier of the memory.
  *
- * @return True if a page was successfully cleared, false otherwise.
+ * @param tier: FAST_TIER or SLOW_TIER.
+ *
+ * @return The number of frames in use.
  */
-bool sim_mem::clear_memory_page()
+int sim_mem::get_used_frames(int tier) const
 {
-    int page_split[] = {text_size, data_size, bss_size,
-                        heap_stack_size}; // Array to store sizes of different sections of memory
-    bool found = false; // Flag to indicate if a page to remove is found
-    int min_time = INT_MAX; // Variable to store the minimum time value
-    int frame_to_remove; // Variable to store the frame index to remove
-    int outer, inner; // Variables to store the outer and inner table indices
+    int first = tier == FAST_TIER ? 0 : fast_frames;
+    int last = tier == FAST_TIER ? fast_frames : fast_frames + slow_frames;
+    int used = 0;
+
+    for (int i = first; i < last; i++)
+        if (!frames_status[i])
+            used++;
+
+    return used;
+}
+
+/**
+ * Estimates the working set: the fast tier pages accessed during the current window. Every access advances
+ * the clock by one, so these are the frames whose access time is within the last window of clock steps.
+ *
+ * @return The number of pages in the working set.
+ */
+int sim_mem::get_working_set() const
+{
+    int pages = 0;
+
+    for (int i = 0; i < fast_frames; i++)
+        if (!frames_status[i] && frames_clock[i] >= clock - allocation.window)
+            pages++;
+
+    return pages;
+}
 
-    // Check which frame should be cleared using the LRU algorithm
-    for (int i = 0; i < MEMORY_SIZE / page_size; i++)
+/**
+ * Adjusts the frame quota once a window of accesses has passed, according to the fault rate of the window,
+ * and reclaims the frames over a shrunk quota. See enable_adaptive_frames.
+ */
+void sim_mem::adapt_frame_quota()
+{
+    long accesses = stats.accesses - window_accesses;
+    if (accesses < allocation.window)
+        return;
+
+    double fault_rate = (double) (stats.faults - window_faults) / accesses;
+    window_accesses = stats.accesses;
+    window_faults = stats.faults;
+
+    // Thrashing - give the pages one more frame
+    if (fault_rate > allocation.high_fault_rate && frame_quota < allocation.max_frames)
+        frame_quota++;
+
+    // Idle - give a frame back, unless the working set still needs it
+    else if (fault_rate < allocation.low_fault_rate && frame_quota > allocation.min_frames &&
+             get_working_set() < frame_quota)
     {
-        if (frames_clock[i] < min_time) // Check if the current frame has a lower time value
+        frame_quota--;
+        reclaim_frames();
+    }
+}
+
+/**
+ * Takes the coldest pages out of the fast tier until they fit in the frame quota: they are demoted to the
+ * slow tier if there is one, and evicted otherwise. A failure stops the reclaim, the next fault retries it.
+ */
+void sim_mem::reclaim_frames()
+{
+    while (get_used_frames(FAST_TIER) > frame_quota)
+    {
+        sim_error result = slow_frames > 0 ? demote_page() : clear_memory_page();
+        if (result != SIM_OK)
+            return;
+
+        stats.reclaims++;
+    }
+}
+
+/**
+ * Finds the least recently used frame holding a page in a tier of the memory.
+ *
+ * @param tier: FAST_TIER or SLOW_TIER.
+ *
+ * @return The index of the frame, or -1 if the tier holds no page.
+ */
+int sim_mem::get_lru_frame(int tier) const
+{
+    int first = tier == FAST_TIER ? 0 : fast_frames;
+    int last = tier == FAST_TIER ? fast_frames : fast_frames + slow_frames;
+    long min_time = LONG_MAX; // Variable to store the minimum time value
+    int lru_frame = -1;
+
+    for (int i = first; i < last; i++)
+    {
+        if (!frames_status[i] && frames_clock[i] < min_time) // Check if the current frame has a lower time value
         {
             min_time = frames_clock[i];
-            frame_to_remove = i;
+            lru_frame = i;
+        }
+    }
+
+    return lru_frame;
+}
+
+/**
+ * Finds the frame to free in a tier of the memory, according to the replacement policy: the least recently
+ * used frame, or with REPLACE_MIN the frame whose page is used again furthest in the future.
+ *
+ * @param tier: FAST_TIER or SLOW_TIER.
+ *
+ * @return The index of the frame, or -1 if the tier holds no page.
+ */
+int sim_mem::get_victim_frame(int tier) const
+{
+    if (policy == REPLACE_LRU)
+        return get_lru_frame(tier);
+
+    int first = tier == FAST_TIER ? 0 : fast_frames;
+    int last = tier == FAST_TIER ? fast_frames : fast_frames + slow_frames;
+    int victim = -1;
+    long victim_use = 0;
+
+    for (int i = first; i < last; i++)
+    {
+        if (frames_status[i])
+            continue;
+
+        // A next use already in the past was a request the simulator rejected: the page has no further use
+        long use = frames_next_use[i] < request_index ? LONG_MAX : frames_next_use[i];
+        if (victim == -1 || use > victim_use)
+        {
+            victim = i;
+            victim_use = use;
         }
     }
 
-    // Check which page is located in the found frame
-    for (int i = 0; i < OUTER_TABLE_SIZE && !found; i++)
+    return victim;
+}
+
+/**
+ * Finds the page held by a frame.
+ *
+ * @param frame: The frame.
+ * @param outer: Where to store the outer index of the page.
+ * @param inner: Where to store the inner index of the page.
+ *
+ * @return True if a page is mapped to the frame, false otherwise.
+ */
+bool sim_mem::get_frame_owner(int frame, int* outer, int* inner) const
+{
+    int page_split[] = {text_size, data_size, bss_size,
+                        heap_stack_size}; // Array to store sizes of different sections of memory
+
+    for (int i = 0; i < OUTER_TABLE_SIZE; i++)
     {
         int num_pages = page_split[i] / page_size; // Calculate the number of pages in the current section
         for (int j = 0; j < num_pages; j++)
         {
-            if (frame_to_remove == page_table[i][j].frame) // Check if the current page is mapped to the frame to remove
+            if (page_table[i][j].valid && page_table[i][j].frame == frame)
             {
-                found = true;
-                inner = j;
-                outer = i;
-                break;
+                *outer = i;
+                *inner = j;
+                return true;
             }
         }
     }
 
-    // Found no page to remove (no valid pages)
-    if (!found)
-        return false;
+    return false;
+}
 
-    // Remove the page with the shortest time from memory
-    page_table[outer][inner].valid = false; // Mark the page as invalid
-    frames_status[page_table[outer][inner].frame] = true; // Mark the frame as available
-    frames_clock[frame_to_remove] = 0; // Reset the time value of the removed frame
+/**
+ * Returns the memory of a frame: frames of the fast tier live in main_memory, the following frames in the slow memory.
+ *
+ * @param frame: The frame.
+ *
+ * @return A pointer to the first byte of the frame.
+ */
+char* sim_mem::frame_data(int frame) const
+{
+    if (frame < fast_frames)
+        return &main_memory[frame * page_size];
+
+    return &slow_memory[(frame - fast_frames) * page_size];
+}
 
-    // Page not dirty - not needed to store in swap file
-    if (!page_table[outer][inner].dirty)
+/**
+ * Moves a page in memory to a free frame, keeping its access time. The old frame is cleared and freed.
+ * A page of a huge page leaves its contiguous frames, so its huge page is split first.
+ *
+ * @param outer: The outer index of the page table.
+ * @param inner: The inner index of the page table.
+ * @param target: The free frame to move the page to.
+ */
+void sim_mem::move_page(int outer, int inner, int target)
+{
+    page_descriptor* p = &page_table[outer][inner];
+    int source = p->frame;
+
+    if (p->huge)
+        split_huge_page(outer, inner);
+
+    memcpy(frame_data(target), frame_data(source), page_size);
+    memset(frame_data(source), '0', page_size);
+
+    frames_status[target] = false;
+    frames_clock[target] = frames_clock[source];
+    frames_next_use[target] = frames_next_use[source];
+    frames_hits[target] = 0;
+    frames_status[source] = true;
+    frames_clock[source] = 0;
+    frames_hits[source] = 0;
+    p->frame = target;
+
+    stats.total_latency += migration_latency;
+}
+
+/**
+ * Frees a frame of the fast tier by moving its least recently used page to the slow tier. If the slow tier
+ * is full, its own least recently used page is removed from memory first.
+ *
+ * @return SIM_OK if a frame was freed, otherwise the reason of the failure.
+ */
+sim_error sim_mem::demote_page()
+{
+    return demote_frame(get_victim_frame(FAST_TIER));
+}
+
+/**
+ * Frees a given frame of the fast tier by moving its page to the slow tier. If the slow tier is full, its
+ * least recently used page is removed from memory first. A frame of a huge page demotes the whole huge page.
+ *
+ * @param frame: The frame of the fast tier.
+ *
+ * @return SIM_OK if the frame was freed, otherwise the reason of the failure.
+ */
+sim_error sim_mem::demote_frame(int frame)
+{
+    int outer, inner;
+
+    if (frame == -1 || !get_frame_owner(frame, &outer, &inner))
+        return SIM_NO_FRAME;
+
+    // A huge page ages as one unit, so it leaves the fast tier as one unit
+    if (page_table[outer][inner].huge)
+        return release_huge_page(outer, inner, true);
+
+    int target = get_memory_space(SLOW_TIER);
+    if (target == -1)
     {
-        for (int i = 0; i < page_size; i++)
-            main_memory[page_table[outer][inner].frame * page_size + i] = '0'; // Clear the memory of the removed page
+        sim_error result = clear_memory_page();
+        if (result != SIM_OK)
+            return result;
 
-        page_table[outer][inner].frame = -1; // Reset the frame index
-        return true;
+        target = get_memory_space(SLOW_TIER);
     }
 
-    // Load the removed page to swap file
-    int location = get_swap_space(); // Get an available location in the swap file
-    if (location == -1)
-        return false;
+    move_page(outer, inner, target);
+    stats.demotions++;
 
-    for (int i = 0; i < page_size; i++)
+    if (trace.is_open())
+        trace.record(TRACE_DEMOTE, clock, outer, inner, target, page_table[outer][inner].swap_index);
+
+    return SIM_OK;
+}
+
+/**
+ * Moves a page of the slow tier to the fast tier. If the fast tier is full, the page trades places with
+ * the least recently used page of the fast tier.
+ *
+ * @param outer: The outer index of the page table.
+ * @param inner: The inner index of the page table.
+ */
+void sim_mem::promote_page(int outer, int inner)
+{
+    int source = page_table[outer][inner].frame;
+    int target = get_memory_space(FAST_TIER);
+
+    if (target == -1)
     {
-        if (!write_to_file(swapfile_fd, location * page_size + i,
-                           &main_memory[page_table[outer][inner].frame * page_size + i], sizeof(char)))
-            return false; // Write the page content to the swap file
+        int cold_outer, cold_inner;
+        int cold_frame = get_victim_frame(FAST_TIER);
+
+        if (cold_frame == -1 || !get_frame_owner(cold_frame, &cold_outer, &cold_inner))
+            return;
 
-        main_memory[page_table[outer][inner].frame * page_size + i] = '0'; // Clear the memory of the removed page
+        exchange_pages(outer, inner, cold_outer, cold_inner);
+        stats.demotions++;
+
+        if (trace.is_open())
+            trace.record(TRACE_DEMOTE, clock, cold_outer, cold_inner, source, page_table[cold_outer][cold_inner].swap_index);
+
+        target = cold_frame;
     }
+    else
+        move_page(outer, inner, target);
+
+    stats.promotions++;
+
+    if (trace.is_open())
+        trace.record(TRACE_PROMOTE, clock, outer, inner, target, page_table[outer][inner].swap_index);
+}
+
+/**
+ * Makes two pages in memory trade frames, each keeping its access time. Pages of huge pages leave their
+ * contiguous frames, so their huge pages are split first.
+ *
+ * @param outer: The outer index of the first page.
+ * @param inner: The inner index of the first page.
+ * @param other_outer: The outer index of the second page.
+ * @param other_inner: The inner index of the second page.
+ */
+void sim_mem::exchange_pages(int outer, int inner, int other_outer, int other_inner)
+{
+    page_descriptor* p = &page_table[outer][inner];
+    page_descriptor* other = &page_table[other_outer][other_inner];
+
+    if (p->huge)
+        split_huge_page(outer, inner);
+    if (other->huge)
+        split_huge_page(other_outer, other_inner);
+
+    int frame = p->frame;
+    int other_frame = other->frame;
+
+    // Exchange the two pages through a temporary copy of one of them
+    char* data = new char[page_size];
+    memcpy(data, frame_data(frame), page_size);
+    memcpy(frame_data(frame), frame_data(other_frame), page_size);
+    memcpy(frame_data(other_frame), data, page_size);
+    delete[] data;
+
+    long clock_value = frames_clock[frame];
+    frames_clock[frame] = frames_clock[other_frame];
+    frames_clock[other_frame] = clock_value;
+
+    long next_use_value = frames_next_use[frame];
+    frames_next_use[frame] = frames_next_use[other_frame];
+    frames_next_use[other_frame] = next_use_value;
+
+    frames_hits[frame] = 0;
+    frames_hits[other_frame] = 0;
+    p->frame = other_frame;
+    other->frame = frame;
+
+    stats.total_latency += 2 * migration_latency;
+}
+
+/**
+ * Accounts an access to a page that is in memory. A page of the slow tier accessed PROMOTE_THRESHOLD times
+ * since it got there is hot, and is promoted to the fast tier.
+ *
+ * @param outer: The outer index of the page table.
+ * @param inner: The inner index of the page table.
+ */
+void sim_mem::record_hit(int outer, int inner)
+{
+    int frame = page_table[outer][inner].frame;
+
+    stats.accesses++;
+    frames_hits[frame]++;
+
+    if (frame < fast_frames)
+    {
+        stats.fast_hits++;
+        stats.total_latency += tier_latency[FAST_TIER];
+        return;
+    }
+
+    stats.slow_hits++;
+    stats.total_latency += tier_latency[SLOW_TIER];
+
+    if (frames_hits[frame] >= PROMOTE_THRESHOLD)
+        promote_page(outer, inner);
+}
+
+/**
+ * Clears a page from the memory using the LRU (Least Recently Used) algorithm. The page is taken from the
+ * slow tier if there is one, and from main_memory otherwise.
+ *
+ * @return SIM_OK if a page was successfully cleared, otherwise the reason of the failure.
+ */
+sim_error sim_mem::clear_memory_page()
+{
+    // Check which frame should be cleared using the LRU algorithm (or MIN, when replaying an offline trace)
+    return evict_frame(get_victim_frame(slow_frames > 0 ? SLOW_TIER : FAST_TIER));
+}
+
+/**
+ * Removes the page of a given frame from memory, adding it to the swap batch if its content must be kept.
+ * A huge page ages as one unit, so a frame of a huge page removes the whole huge page.
+ *
+ * @param frame_to_remove: The frame.
+ *
+ * @return SIM_OK if the page was successfully cleared, otherwise the reason of the failure.
+ */
+sim_error sim_mem::evict_frame(int frame_to_remove)
+{
+    int outer, inner; // Variables to store the outer and inner table indices
+
+    // Found no page to remove (no valid pages)
+    if (frame_to_remove == -1 || !get_frame_owner(frame_to_remove, &outer, &inner))
+        return SIM_NO_FRAME;
+
+    if (page_table[outer][inner].huge)
+        return release_huge_page(outer, inner, false);
+
+    // Page dirty, and its copy in the swap file missing or stale - it has to be stored in the swap file
+    bool swap_out = page_table[outer][inner].dirty &&
+                    (page_table[outer][inner].swap_index == -1 || page_table[outer][inner].modified);
+
+    // If the swap batch can not take the page, it stays in memory rather than losing its content
+    if (swap_out)
+    {
+        sim_error room = make_batch_room();
+        if (room != SIM_OK)
+            return room;
+    }
+
+    // Remove the page with the shortest time from memory
+    page_table[outer][inner].valid = false; // Mark the page as invalid
+    frames_status[page_table[outer][inner].frame] = true; // Mark the frame as available
+    frames_clock[frame_to_remove] = 0; // Reset the time value of the removed frame
+    stats.evictions++;
+
+    if (trace.is_open())
+        trace.record(TRACE_EVICT, clock, outer, inner, frame_to_remove, page_table[outer][inner].swap_index);
+
+    // Add the removed page to the swap batch, it is written to the swap file together with other evicted pages.
+    // The batch has room, so the page is staged: if writing the full batch fails, the batch is kept and the
+    // write is retried (and reported) by the next swap-out
+    if (swap_out)
+        stage_swap_out(outer, inner, frame_to_remove);
+
+    memset(frame_data(frame_to_remove), '0', page_size); // Clear the memory of the removed page
 
     page_table[outer][inner].frame = -1; // Reset the frame index
-    page_table[outer][inner].swap_index = location; // Update the swap index of the removed page
-    swap_status[location] = false; // Mark the swap location as occupied
 
-    return true; // Page removal was successful
+    return SIM_OK; // Page removal was successful
 }
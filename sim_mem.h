@@ -12,6 +12,9 @@
 #include <fcntl.h>
 #include <cmath>
 #include <climits>
+#include <sys/uio.h>
+#include "sim_error.h"
+#include "event_trace.h"
 
 // Constants for the simulation
 #define OUTER_TABLE_SIZE 4
@@ -19,6 +22,18 @@
 #define NEW_PAGE (-1)
 #define MIN_ADDRESS 0 // Min logical address allowed
 #define MAX_ADDRESS 4095 // Max logical address allowed (12 bits)
+#define SEGMENT_SHIFT 10 // Logical address bits below the outer (segment) index
+#define SWAP_CLUSTER_SIZE 4 // Swap slots in a cluster, the unit of sequential writeback and readahead
+#define FAST_TIER 0 // Frames in main_memory
+#define SLOW_TIER 1 // Frames in the optional slow memory
+#define PROMOTE_THRESHOLD 4 // Accesses to a page in the slow tier that move it to the fast tier
+#define FAST_TIER_LATENCY 80 // Default cost of an access to the fast tier (ns)
+#define SLOW_TIER_LATENCY 300 // Default cost of an access to the slow tier (ns)
+#define PAGE_FAULT_LATENCY 100000 // Default cost of loading a page on a fault (ns)
+#define MIGRATION_LATENCY 1000 // Default cost of moving a page between the tiers (ns)
+#define FRAME_WINDOW 64 // Default accesses in a window of the adaptive frame allocation
+#define HIGH_FAULT_RATE 0.25 // Default fault rate above which the frame quota grows
+#define LOW_FAULT_RATE 0.05 // Default fault rate below which the frame quota shrinks
 
 extern char main_memory[MEMORY_SIZE];  // The main memory of the simulated system
 
@@ -28,10 +43,55 @@ typedef struct page_descriptor
 {
     bool valid;       // Is the page currently in memory?
     int frame;        // The frame where the page is loaded in memory
-    bool dirty;       // Has the page been modified since it was loaded?
+    bool dirty;       // Has the page ever been modified? (its content then lives in the swap file)
+    bool modified;    // Has the page been modified since it was last written to or read from the swap file?
     int swap_index;   // The location of the page in the swap file
+    bool huge;        // Is the page mapped as part of a huge page? (see huge_descriptor)
 } page_descriptor;
 
+// Descriptor of an aligned block of base pages that may be mapped as one huge page
+typedef struct huge_descriptor
+{
+    bool valid;       // Is the block mapped as a huge page, in contiguous frames of the fast tier?
+    int frame;        // The first frame of the huge page, the base page i of the block is in frame + i
+} huge_descriptor;
+
+// Counters of the accesses made to the simulated memory
+typedef struct sim_stats
+{
+    long accesses;         // Successful loads and stores
+    long fast_hits;        // Accesses to pages in the fast tier
+    long slow_hits;        // Accesses to pages in the slow tier
+    long faults;           // Accesses that had to load the page first
+    long promotions;       // Pages moved from the slow tier to the fast tier
+    long demotions;        // Pages moved from the fast tier to the slow tier
+    long evictions;        // Pages removed from memory
+    long reclaims;         // Pages taken out of the fast tier because the frame quota shrank
+    long huge_faults;      // Faults that mapped a whole huge page
+    long splits;           // Huge pages split back into base pages
+    long collapses;        // Blocks of resident base pages collapsed into huge pages
+    double total_latency;  // Estimated time spent on all accesses (ns)
+} sim_stats;
+
+// Page replacement policies
+typedef enum replacement_policy
+{
+    REPLACE_LRU = 0,  // Evict the least recently used page
+    REPLACE_MIN       // Evict the page used furthest in the future (Belady), needs set_next_use before every access
+} replacement_policy;
+
+// Parameters of the adaptive frame allocation (page fault frequency with a working set floor)
+typedef struct frame_allocation
+{
+    int min_frames;          // The frame quota never goes below this
+    int max_frames;          // The frame quota never goes above this
+    int window;              // Accesses between two adjustments of the quota
+    double high_fault_rate;  // Faults per access in a window above which the quota grows
+    double low_fault_rate;   // Faults per access in a window below which the quota shrinks
+} frame_allocation;
+
+frame_allocation make_frame_allocation(int min_frames, int max_frames);  // Allocation with the default window and fault rates
+
 using std::string;
 
 // Class for simulating memory management
@@ -45,31 +105,109 @@ class sim_mem {
     int heap_stack_size;   // Size of the heap/stack
     int page_size;         // Size of a single page
     page_descriptor **page_table; // Pointer to the page table
-    int swap_size;         // Size of the swap file
+    int swap_size;         // Number of slots in the swap file
+    int swap_clusters;     // Number of clusters in the swap file
     int inner_table_size;  // Size of the inner page table
+    int fast_frames;       // Number of frames in main_memory, frames 0 to fast_frames - 1
+    int slow_frames;       // Number of frames in slow_memory, following the fast frames
+    char* slow_memory;     // The slow tier of the memory, nullptr if there is none
     bool* frames_status;   // Array to track the status of each frame in memory
     bool* swap_status;     // Array to track the status of each page in the swap file
-    int* frames_clock;     // Array to track the "age" of each frame in memory
-    int clock;             // The current time step in the simulation
+    page_descriptor** swap_owner; // Array to track which page holds each slot in the swap file
+    char* swap_batch;      // Evicted pages waiting to be written to the swap file together
+    int* batch_outer;      // Outer index of each page in the swap batch
+    int* batch_inner;      // Inner index of each page in the swap batch
+    int batch_count;       // Number of pages in the swap batch
+    char* swap_readahead;  // Content of the swap cluster read last
+    int readahead_cluster; // The cluster held in swap_readahead, -1 if none
+    long* frames_clock;    // Array to track the "age" of each frame in memory
+    int* frames_hits;      // Array to track the accesses to each frame since its page got there
+    long* frames_next_use; // Array to track when the page of each frame is used next (REPLACE_MIN)
+    replacement_policy policy; // How the page to evict is chosen
+    long next_use;         // When the page of the current access is used next (REPLACE_MIN)
+    long request_index;    // Index in the trace of the current access (REPLACE_MIN)
+    sim_stats stats;       // Counters of the accesses
+    double tier_latency[2]; // Cost of an access to each tier (ns)
+    double fault_latency;  // Cost of loading a page on a fault (ns)
+    double migration_latency; // Cost of moving a page between the tiers (ns)
+    bool adaptive;         // Is the number of fast tier frames in use adapted to the fault rate?
+    frame_allocation allocation; // Parameters of the adaptive frame allocation
+    int frame_quota;       // Fast tier frames the pages may use, fast_frames unless adaptive
+    long window_accesses;  // Accesses at the start of the current window
+    long window_faults;    // Faults at the start of the current window
+    int huge_pages[OUTER_TABLE_SIZE]; // Base pages in a huge page of each segment, 0 if the segment has no huge pages
+    huge_descriptor** huge_table; // Huge page descriptors of each segment, one per aligned block (a partial last block is never valid)
+    long clock;            // The current time step in the simulation
+    error_log errors;      // Failure counters and the error message sink
+    event_trace trace;     // Binary trace of paging events, when enabled
 
 public:
-    sim_mem(char exe_file_name[], char swap_file_name[], int text_size, int data_size, int bss_size, int heap_stack_size, int page_size);  // Constructor
+    sim_mem(char exe_file_name[], char swap_file_name[], int text_size, int data_size, int bss_size, int heap_stack_size, int page_size, int slow_memory_size = 0);  // Constructor
     ~sim_mem();  // Destructor
     char load(int address);  // Load a byte from the given address
     void store(int address, char value);  // Store a byte to the given address
+    sim_error try_load(int address, char* value);  // Load a byte, reporting the result
+    sim_error try_store(int address, char value);  // Store a byte, reporting the result
+    void set_error_log(FILE* stream, int max_per_second);  // Set where and how often errors are logged
+    long error_count(sim_error error) const;  // Number of failures of the given kind
+    bool enable_event_trace(const char* file_name, size_t capacity = TRACE_DEFAULT_CAPACITY);  // Start tracing paging events
+    void disable_event_trace();  // Stop tracing paging events
+    long dropped_trace_events() const;  // Paging events lost because the trace buffer was full
     void print_memory();  // Print the current state of the memory
     void print_swap ();  // Print the current state of the swap file
     void print_page_table();  // Print the current state of the page table
+    sim_error flush_swap_batch();  // Write the pending evicted pages to the swap file
+    sim_error compact_swap();  // Reclaim fragmented swap clusters
+    void set_tier_latencies(double fast, double slow, double fault, double migration);  // Set the latency cost model
+    void set_replacement_policy(replacement_policy policy);  // Set how the page to evict is chosen
+    void set_next_use(long index, long next_use);  // Set the trace index of the next access and when its page is used again (REPLACE_MIN)
+    bool enable_adaptive_frames(const frame_allocation& allocation);  // Adapt the fast tier frames in use to the fault rate
+    void disable_adaptive_frames();  // Let the pages use every fast tier frame again
+    int get_frame_quota() const;  // Fast tier frames the pages may use
+    bool enable_huge_pages(int segment, int pages);  // Map a segment with huge pages of the given number of base pages
+    void disable_huge_pages(int segment);  // Map a segment with base pages only
+    int collapse_huge_pages();  // Collapse blocks of resident base pages into huge pages
+    sim_stats get_stats() const;  // Counters of the accesses so far
+    double get_average_access_time() const;  // Estimated average memory access time (ns)
+    void print_stats();  // Print the counters and the estimated average memory access time
 
 private:
     static long get_logical_address(long num);  // Function to get logical address from a given number
     void get_physical_address(long address, int* outer, int* inner, int* offset) const;  // Function to get physical address from a given logical address
     static char* read_from_file(int fd, int location, int amount);  // Function to read from file
     static bool write_to_file(int fd, off_t location, const char* data, size_t size);  // Function to write to file
-    bool load_to_memory(page_descriptor* p, int fd, int location);  // Function to load page to memory
-    bool clear_memory_page();  // Function to clear memory page
-    int get_memory_space();  // Function to get available memory space
-    int get_swap_space() const;  // Function to get available swap space
+    sim_error load_to_memory(int outer, int inner, int fd, int location);  // Function to load page to memory
+    sim_error fill_frame(int outer, int inner, int frame, int fd, int location);  // Function to load a page into a given free frame
+    sim_error clear_memory_page();  // Function to clear memory page
+    sim_error evict_frame(int frame);  // Function to remove the page of a frame from memory
+    int get_memory_space(int tier);  // Function to get available memory space
+    int get_used_frames(int tier) const;  // Function to count the frames holding a page in a tier
+    int get_working_set() const;  // Function to count the fast tier pages accessed in the current window
+    void adapt_frame_quota();  // Function to adjust the frame quota at the end of a window
+    void reclaim_frames();  // Function to take pages out of the fast tier down to the frame quota
+    int get_lru_frame(int tier) const;  // Function to get the least recently used frame of a tier
+    int get_victim_frame(int tier) const;  // Function to get the frame to free in a tier, according to the policy
+    bool get_frame_owner(int frame, int* outer, int* inner) const;  // Function to get the page held by a frame
+    char* frame_data(int frame) const;  // Function to get the memory of a frame
+    void move_page(int outer, int inner, int target);  // Function to move a page to another frame
+    sim_error demote_page();  // Function to move the coldest fast tier page to the slow tier
+    sim_error demote_frame(int frame);  // Function to move the page of a fast tier frame to the slow tier
+    void exchange_pages(int outer, int inner, int other_outer, int other_inner);  // Function to make two pages in memory trade frames
+    void promote_page(int outer, int inner);  // Function to move a hot slow tier page to the fast tier
+    void record_hit(int outer, int inner);  // Function to account an access to a page in memory
+    bool can_map_huge(int outer, int inner) const;  // Function to check if a fault may map the page's whole huge page
+    sim_error load_huge_page(int outer, int inner, bool store);  // Function to map the huge page of a page with one fault
+    int access_huge_page(int outer, int inner);  // Function to account an access to a page of a huge page
+    void split_huge_page(int outer, int inner);  // Function to split the huge page of a page back into base pages
+    void unmap_huge_page(int outer, int inner);  // Function to drop the huge page descriptor of a page's block
+    sim_error release_huge_page(int outer, int inner, bool demote);  // Function to evict or demote a whole huge page
+    void get_page_source(int outer, int inner, bool store, int* fd, int* location) const;  // Function to get where a page is loaded from
+    int get_swap_cluster(bool most_free, int exclude) const;  // Function to get a swap cluster with available space
+    int get_free_swap_clusters() const;  // Function to count the swap clusters with no live page
+    sim_error make_batch_room();  // Function to make sure the swap batch can take one more page
+    sim_error stage_swap_out(int outer, int inner, int frame);  // Function to add an evicted page to the swap batch
+    sim_error read_swap_page(page_descriptor* p, char* data);  // Function to read a page back from the swap file
+    void release_swap_slot(int slot);  // Function to free a slot of the swap file
     static void init_page(page_descriptor* pd);  // Function to initialize page descriptor
     bool is_legal(int outer, int inner);  // Function to check if address is legal
     char get_memory_content(int outer, int inner, int offset);  // Function to get content from memory
@@ -0,0 +1,570 @@
+#ifndef EX4_STATIC_SIM_MEM_H
+#define EX4_STATIC_SIM_MEM_H
+
+#include "sim_mem.h"
+
+/**
+ * Computes log2 of a power of two at compile time.
+ *
+ * @param n: The value to take the logarithm of.
+ *
+ * @return: The base-2 logarithm of n.
+ */
+constexpr int static_log2(int n)
+{
+    return n <= 1 ? 0 : 1 + static_log2(n / 2);
+}
+
+/**
+ * Memory simulator with a geometry fixed at compile time.
+ *
+ * Behaves like a single tier sim_mem (same page types, same LRU replacement and the same printouts), but
+ * the page size, the number of frames and the segment sizes are template parameters. The swap file is a
+ * plain array of page slots filled first-fit, one write per evicted page: it has none of sim_mem's swap
+ * clusters, batched writeback, readahead or compaction, so slot placement differs from sim_mem's.
+ * Address decoding is done with constant shifts and masks, the page table is a single flat array and
+ * every bound is a constant, so the hit path of load/store compiles down to a handful of instructions.
+ * Use sim_mem for geometries only known at runtime.
+ *
+ * @tparam PAGE_SIZE: Size of a single page (power of two).
+ * @tparam NUM_OF_FRAMES: Number of frames in the simulated main memory.
+ * @tparam TEXT_SIZE: Size of the .text section.
+ * @tparam DATA_SIZE: Size of the .data section.
+ * @tparam BSS_SIZE: Size of the .bss section.
+ * @tparam HEAP_STACK_SIZE: Size of the heap/stack.
+ */
+template <int PAGE_SIZE, int NUM_OF_FRAMES, int TEXT_SIZE, int DATA_SIZE, int BSS_SIZE, int HEAP_STACK_SIZE>
+class static_sim_mem {
+
+    static_assert(PAGE_SIZE > 0 && (PAGE_SIZE & (PAGE_SIZE - 1)) == 0, "Page size must be a power of two");
+    static_assert(NUM_OF_FRAMES > 0, "At least one frame is required");
+    static_assert(TEXT_SIZE % PAGE_SIZE == 0 && DATA_SIZE % PAGE_SIZE == 0 &&
+                  BSS_SIZE % PAGE_SIZE == 0 && HEAP_STACK_SIZE % PAGE_SIZE == 0,
+                  "Segment sizes must be multiples of the page size");
+    static_assert(TEXT_SIZE <= (1 << SEGMENT_SHIFT) && DATA_SIZE <= (1 << SEGMENT_SHIFT) &&
+                  BSS_SIZE <= (1 << SEGMENT_SHIFT) && HEAP_STACK_SIZE <= (1 << SEGMENT_SHIFT),
+                  "A segment can not be larger than its share of the logical address space");
+
+    static constexpr int OFFSET_BITS = static_log2(PAGE_SIZE);  // Bits of the offset inside a page
+    static constexpr int OFFSET_MASK = PAGE_SIZE - 1;           // Mask extracting the offset
+    static constexpr int INNER_MASK = (1 << (SEGMENT_SHIFT - OFFSET_BITS)) - 1;  // Mask extracting the inner index
+    static constexpr int TEXT_PAGES = TEXT_SIZE / PAGE_SIZE;
+    static constexpr int DATA_PAGES = DATA_SIZE / PAGE_SIZE;
+    static constexpr int BSS_PAGES = BSS_SIZE / PAGE_SIZE;
+    static constexpr int HEAP_STACK_PAGES = HEAP_STACK_SIZE / PAGE_SIZE;
+    static constexpr int TOTAL_PAGES = TEXT_PAGES + DATA_PAGES + BSS_PAGES + HEAP_STACK_PAGES;
+    static constexpr int SWAP_SIZE = DATA_PAGES + BSS_PAGES + HEAP_STACK_PAGES;  // Pages in the swap file
+
+    int swapfile_fd;                         // File descriptor for the swap file
+    int program_fd;                          // File descriptor for the executable file
+    char memory[NUM_OF_FRAMES * PAGE_SIZE];  // The main memory of this instance
+    page_descriptor page_table[TOTAL_PAGES]; // All segments, one after another
+    bool swap_status[SWAP_SIZE > 0 ? SWAP_SIZE : 1];  // Status of each page in the swap file
+    int frames_clock[NUM_OF_FRAMES];         // The "age" of each frame in memory
+    int frames_owner[NUM_OF_FRAMES];         // Page table index of the page held by each frame, -1 if free
+    int clock;                               // The current time step in the simulation
+    error_log errors;                        // Failure counters and the error message sink
+
+public:
+    static_sim_mem(const char exe_file_name[], const char swap_file_name[]);  // Constructor
+    ~static_sim_mem();  // Destructor
+    static_sim_mem(const static_sim_mem&) = delete;
+    static_sim_mem& operator=(const static_sim_mem&) = delete;
+
+    /**
+     * Fetches a byte from the specified address, see sim_mem::load.
+     *
+     * @param address: The logical address to load from.
+     *
+     * @return The byte from the given address, or '\0' in case of an error.
+     */
+    char load(int address)
+    {
+        char value = '\0';
+        try_load(address, &value);
+        return value;
+    }
+
+    /**
+     * Writes a byte to the specified address, see sim_mem::store.
+     *
+     * @param address: The logical memory address to store the value at.
+     * @param value: The value to store in memory.
+     */
+    void store(int address, char value)
+    {
+        try_store(address, value);
+    }
+
+    /**
+     * Fetches a byte from the specified address, see sim_mem::try_load.
+     *
+     * @param address: The logical address to load from.
+     * @param value: Where to store the loaded byte.
+     *
+     * @return SIM_OK on success, otherwise the reason of the failure.
+     */
+    sim_error try_load(int address, char* value)
+    {
+        if (address < MIN_ADDRESS || address > MAX_ADDRESS)
+            return errors.record(SIM_ILLEGAL_ADDRESS, address);
+
+        int outer = address >> SEGMENT_SHIFT;
+        int inner = (address >> OFFSET_BITS) & INNER_MASK;
+        int offset = address & OFFSET_MASK;
+
+        if (inner < pages_in(outer))
+        {
+            page_descriptor& pd = page_table[page_index(outer, inner)];
+            if (pd.valid)
+            {
+                frames_clock[pd.frame] = clock++;
+                *value = memory[(pd.frame << OFFSET_BITS) | offset];
+                return SIM_OK;
+            }
+        }
+
+        return load_slow(address, value);
+    }
+
+    /**
+     * Writes a byte to the specified address, see sim_mem::try_store.
+     *
+     * @param address: The logical memory address to store the value at.
+     * @param value: The value to store in memory.
+     *
+     * @return SIM_OK on success, otherwise the reason of the failure.
+     */
+    sim_error try_store(int address, char value)
+    {
+        if (address < MIN_ADDRESS || address > MAX_ADDRESS)
+            return errors.record(SIM_ILLEGAL_ADDRESS, address);
+
+        int outer = address >> SEGMENT_SHIFT;
+        int inner = (address >> OFFSET_BITS) & INNER_MASK;
+        int offset = address & OFFSET_MASK;
+
+        if (outer != 0 && inner < pages_in(outer))
+        {
+            page_descriptor& pd = page_table[page_index(outer, inner)];
+            if (pd.valid)
+            {
+                frames_clock[pd.frame] = clock++;
+                memory[(pd.frame << OFFSET_BITS) | offset] = value;
+                pd.dirty = true;
+                pd.modified = true;
+                return SIM_OK;
+            }
+        }
+
+        return store_slow(address, value);
+    }
+
+    /**
+     * Sets where failures are logged and how many messages are allowed per second, see sim_mem::set_error_log.
+     *
+     * @param stream: The stream to log to, or nullptr to only count failures.
+     * @param max_per_second: Maximal number of messages per second, 0 for no limit.
+     */
+    void set_error_log(FILE* stream, int max_per_second)
+    {
+        errors.set_stream(stream, max_per_second);
+    }
+
+    /**
+     * @param error: The kind of failure.
+     *
+     * @return The number of failures of the given kind since the simulator was created.
+     */
+    long error_count(sim_error error) const
+    {
+        return errors.count(error);
+    }
+
+    void print_memory();  // Print the current state of the memory
+    void print_swap();  // Print the current state of the swap file
+    void print_page_table();  // Print the current state of the page table
+
+private:
+    /**
+     * @param outer: Index of the segment.
+     *
+     * @return The number of pages in the given segment.
+     */
+    static constexpr int pages_in(int outer)
+    {
+        return outer == 0 ? TEXT_PAGES : outer == 1 ? DATA_PAGES : outer == 2 ? BSS_PAGES : HEAP_STACK_PAGES;
+    }
+
+    /**
+     * @param outer: Index of the segment.
+     * @param inner: Index of the page inside the segment.
+     *
+     * @return The index of the page in the flat page table.
+     */
+    static constexpr int page_index(int outer, int inner)
+    {
+        return (outer == 0 ? 0 : outer == 1 ? TEXT_PAGES : outer == 2 ? TEXT_PAGES + DATA_PAGES
+                : TEXT_PAGES + DATA_PAGES + BSS_PAGES) + inner;
+    }
+
+    /**
+     * @param outer: Index of the segment (text, data or BSS).
+     *
+     * @return The offset of the segment in the executable file.
+     */
+    static constexpr int segment_file_offset(int outer)
+    {
+        return outer == 0 ? 0 : outer == 1 ? TEXT_SIZE : TEXT_SIZE + DATA_SIZE;
+    }
+
+    sim_error load_slow(int address, char* value);  // Fault path of load
+    sim_error store_slow(int address, char value);  // Fault path of store
+    sim_error load_to_memory(int index, int fd, int location);  // Function to load page to memory
+    sim_error clear_memory_page();  // Function to clear memory page
+    int get_memory_space() const;  // Function to get available memory space
+    int get_swap_space() const;  // Function to get available swap space
+};
+
+
+/**
+ * Opens the executable and swap files and initializes the memory, the swap file and the page table.
+ * In case of file opening failures, the program will exit with an error.
+ *
+ * @param exe_file_name: The name of the executable file.
+ * @param swap_file_name: The name of the swap file.
+ */
+template <int PAGE_SIZE, int NUM_OF_FRAMES, int TEXT_SIZE, int DATA_SIZE, int BSS_SIZE, int HEAP_STACK_SIZE>
+static_sim_mem<PAGE_SIZE, NUM_OF_FRAMES, TEXT_SIZE, DATA_SIZE, BSS_SIZE, HEAP_STACK_SIZE>::static_sim_mem(
+        const char exe_file_name[], const char swap_file_name[]) : swapfile_fd(-1), program_fd(-1), clock(0)
+{
+    for (char &element: memory)
+        element = '0';
+
+    for (bool &element: swap_status)
+        element = true;
+
+    for (int i = 0; i < NUM_OF_FRAMES; i++)
+    {
+        frames_clock[i] = -1;
+        frames_owner[i] = -1;
+    }
+
+    for (page_descriptor &pd: page_table)
+    {
+        pd.valid = false;
+        pd.frame = -1;
+        pd.dirty = false;
+        pd.modified = false;
+        pd.swap_index = -1;
+        pd.huge = false;
+    }
+
+    if (exe_file_name == nullptr || swap_file_name == nullptr)
+    {
+        std::cout << "ERR" << std::endl;
+        return;
+    }
+
+    program_fd = open(exe_file_name, O_RDONLY);
+    if (program_fd == -1)
+    {
+        perror("ERR\n");
+        exit(EXIT_FAILURE);
+    }
+
+    swapfile_fd = open(swap_file_name, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+    if (swapfile_fd == -1)
+    {
+        perror("ERR\n");
+        close(program_fd);
+        exit(EXIT_FAILURE);
+    }
+
+    // Initializing the swap file with 0s, one page at a time
+    char zeros[PAGE_SIZE];
+    memset(zeros, '0', PAGE_SIZE);
+    for (int i = 0; i < SWAP_SIZE; i++)
+        if (pwrite(swapfile_fd, zeros, PAGE_SIZE, (off_t) i * PAGE_SIZE) != PAGE_SIZE)
+        {
+            perror("ERR\n");
+            return;
+        }
+}
+
+/**
+ * Destructor, closes the file descriptors.
+ */
+template <int PAGE_SIZE, int NUM_OF_FRAMES, int TEXT_SIZE, int DATA_SIZE, int BSS_SIZE, int HEAP_STACK_SIZE>
+static_sim_mem<PAGE_SIZE, NUM_OF_FRAMES, TEXT_SIZE, DATA_SIZE, BSS_SIZE, HEAP_STACK_SIZE>::~static_sim_mem()
+{
+    if (swapfile_fd != -1)
+        close(swapfile_fd);
+    if (program_fd != -1)
+        close(program_fd);
+}
+
+/**
+ * Fault path of load, taken when the page is not in memory or the address is illegal.
+ *
+ * @param address: The logical address to load from, known to be in range.
+ * @param value: Where to store the loaded byte.
+ *
+ * @return SIM_OK on success, otherwise the reason of the failure.
+ */
+template <int PAGE_SIZE, int NUM_OF_FRAMES, int TEXT_SIZE, int DATA_SIZE, int BSS_SIZE, int HEAP_STACK_SIZE>
+sim_error static_sim_mem<PAGE_SIZE, NUM_OF_FRAMES, TEXT_SIZE, DATA_SIZE, BSS_SIZE, HEAP_STACK_SIZE>::load_slow(
+        int address, char* value)
+{
+    int outer = address >> SEGMENT_SHIFT;
+    int inner = (address >> OFFSET_BITS) & INNER_MASK;
+    int offset = address & OFFSET_MASK;
+
+    if (inner >= pages_in(outer))
+        return errors.record(SIM_ILLEGAL_ADDRESS, address);
+
+    int index = page_index(outer, inner);
+    sim_error result;
+
+    // Text pages always come from the program file, dirty pages from the swap file
+    if (outer == 0)
+        result = load_to_memory(index, program_fd, (inner << OFFSET_BITS));
+    else if (page_table[index].dirty)
+        result = load_to_memory(index, swapfile_fd, -1);
+    else if (outer == 3)
+        result = SIM_UNINITIALIZED_HEAP_READ;  // Heap/stack pages have to be created via store first
+    else
+        result = load_to_memory(index, program_fd, segment_file_offset(outer) + (inner << OFFSET_BITS));
+
+    if (result != SIM_OK)
+        return errors.record(result, address);
+
+    *value = memory[(page_table[index].frame << OFFSET_BITS) | offset];
+    return SIM_OK;
+}
+
+/**
+ * Fault path of store, taken when the page is not in memory or the address is illegal.
+ *
+ * @param address: The logical address to store to, known to be in range.
+ * @param value: The value to store in memory.
+ *
+ * @return SIM_OK on success, otherwise the reason of the failure.
+ */
+template <int PAGE_SIZE, int NUM_OF_FRAMES, int TEXT_SIZE, int DATA_SIZE, int BSS_SIZE, int HEAP_STACK_SIZE>
+sim_error static_sim_mem<PAGE_SIZE, NUM_OF_FRAMES, TEXT_SIZE, DATA_SIZE, BSS_SIZE, HEAP_STACK_SIZE>::store_slow(
+        int address, char value)
+{
+    int outer = address >> SEGMENT_SHIFT;
+    int inner = (address >> OFFSET_BITS) & INNER_MASK;
+    int offset = address & OFFSET_MASK;
+
+    if (inner >= pages_in(outer))
+        return errors.record(SIM_ILLEGAL_ADDRESS, address);
+
+    // Text pages are read-only
+    if (outer == 0)
+        return errors.record(SIM_WRITE_TO_TEXT, address);
+
+    int index = page_index(outer, inner);
+    sim_error result;
+
+    if (page_table[index].dirty)
+        result = load_to_memory(index, swapfile_fd, -1);
+    else if (outer == 1)
+        result = load_to_memory(index, program_fd, segment_file_offset(outer) + (inner << OFFSET_BITS));
+    else
+        result = load_to_memory(index, NEW_PAGE, -1);  // BSS and heap/stack pages start as new pages
+
+    if (result != SIM_OK)
+        return errors.record(result, address);
+
+    memory[(page_table[index].frame << OFFSET_BITS) | offset] = value;
+    page_table[index].dirty = true;
+    page_table[index].modified = true;
+    return SIM_OK;
+}
+
+/**
+ * Loads a page into memory from either the swap file, the program file, or initializes a new page.
+ *
+ * @param index: Index of the page in the flat page table.
+ * @param fd: The file descriptor, which determines the source of the data to be loaded.
+ * @param location: The location in the file to read from.
+ *
+ * @return: SIM_OK if the operation is successful, otherwise the reason of the failure.
+ */
+template <int PAGE_SIZE, int NUM_OF_FRAMES, int TEXT_SIZE, int DATA_SIZE, int BSS_SIZE, int HEAP_STACK_SIZE>
+sim_error static_sim_mem<PAGE_SIZE, NUM_OF_FRAMES, TEXT_SIZE, DATA_SIZE, BSS_SIZE, HEAP_STACK_SIZE>::load_to_memory(
+        int index, int fd, int location)
+{
+    page_descriptor* p = &page_table[index];
+    int frame = get_memory_space();
+
+    if (frame == -1)
+    {
+        sim_error result = clear_memory_page();
+        if (result != SIM_OK)
+            return result;
+
+        frame = get_memory_space();
+    }
+
+    char* destination = &memory[frame << OFFSET_BITS];
+
+    if (fd == NEW_PAGE)
+        memset(destination, '0', PAGE_SIZE);
+    else
+    {
+        if (fd == swapfile_fd)
+            location = p->swap_index << OFFSET_BITS;
+
+        // Read straight into the frame, the frame stays free on failure
+        if (pread(fd, destination, PAGE_SIZE, location) <= 0)
+            return SIM_IO_ERROR;
+
+        // The page keeps its swap slot, the copy there stays valid until the page is modified
+        if (fd == swapfile_fd)
+            p->modified = false;
+    }
+
+    p->frame = frame;
+    p->valid = true;
+    frames_owner[frame] = index;
+    frames_clock[frame] = clock++;
+
+    return SIM_OK;
+}
+
+/**
+ * Clears a page from the main memory using the LRU (Least Recently Used) algorithm.
+ *
+ * @return SIM_OK if a page was successfully cleared, otherwise the reason of the failure.
+ */
+template <int PAGE_SIZE, int NUM_OF_FRAMES, int TEXT_SIZE, int DATA_SIZE, int BSS_SIZE, int HEAP_STACK_SIZE>
+sim_error static_sim_mem<PAGE_SIZE, NUM_OF_FRAMES, TEXT_SIZE, DATA_SIZE, BSS_SIZE, HEAP_STACK_SIZE>::clear_memory_page()
+{
+    int min_time = INT_MAX;
+    int frame_to_remove = -1;
+
+    for (int i = 0; i < NUM_OF_FRAMES; i++)
+    {
+        if (frames_owner[i] != -1 && frames_clock[i] < min_time)
+        {
+            min_time = frames_clock[i];
+            frame_to_remove = i;
+        }
+    }
+
+    // Found no page to remove (no valid pages)
+    if (frame_to_remove == -1)
+        return SIM_NO_FRAME;
+
+    page_descriptor* p = &page_table[frames_owner[frame_to_remove]];
+    char* source = &memory[frame_to_remove << OFFSET_BITS];
+
+    // Dirty pages are written to the swap file as a whole page, unless the copy there is up to date
+    if (p->dirty && (p->swap_index == -1 || p->modified))
+    {
+        int location = p->swap_index != -1 ? p->swap_index : get_swap_space();
+        if (location == -1)
+            return SIM_SWAP_FULL;
+
+        if (pwrite(swapfile_fd, source, PAGE_SIZE, (off_t) location << OFFSET_BITS) == -1)
+            return SIM_IO_ERROR;
+
+        p->swap_index = location;
+        p->modified = false;
+        swap_status[location] = false;
+    }
+
+    memset(source, '0', PAGE_SIZE);
+    p->valid = false;
+    p->frame = -1;
+    frames_owner[frame_to_remove] = -1;
+    frames_clock[frame_to_remove] = 0;
+
+    return SIM_OK;
+}
+
+/**
+ * Finds the first available space in the main memory.
+ *
+ * @return The index of the available space, or -1 if no space is available.
+ */
+template <int PAGE_SIZE, int NUM_OF_FRAMES, int TEXT_SIZE, int DATA_SIZE, int BSS_SIZE, int HEAP_STACK_SIZE>
+int static_sim_mem<PAGE_SIZE, NUM_OF_FRAMES, TEXT_SIZE, DATA_SIZE, BSS_SIZE, HEAP_STACK_SIZE>::get_memory_space() const
+{
+    for (int i = 0; i < NUM_OF_FRAMES; i++)
+        if (frames_owner[i] == -1)
+            return i;
+
+    return -1;
+}
+
+/**
+ * Finds the first available space in the swap file.
+ *
+ * @return: The index of the available space, or -1 if no space is available.
+ */
+template <int PAGE_SIZE, int NUM_OF_FRAMES, int TEXT_SIZE, int DATA_SIZE, int BSS_SIZE, int HEAP_STACK_SIZE>
+int static_sim_mem<PAGE_SIZE, NUM_OF_FRAMES, TEXT_SIZE, DATA_SIZE, BSS_SIZE, HEAP_STACK_SIZE>::get_swap_space() const
+{
+    for (int i = 0; i < SWAP_SIZE; i++)
+        if (swap_status[i])
+            return i;
+
+    return -1;
+}
+
+/**
+ * Prints the current state of the physical memory.
+ */
+template <int PAGE_SIZE, int NUM_OF_FRAMES, int TEXT_SIZE, int DATA_SIZE, int BSS_SIZE, int HEAP_STACK_SIZE>
+void static_sim_mem<PAGE_SIZE, NUM_OF_FRAMES, TEXT_SIZE, DATA_SIZE, BSS_SIZE, HEAP_STACK_SIZE>::print_memory()
+{
+    errors.flush();
+    printf("\n Physical memory\n");
+    for (char element: memory)
+        printf("[%c]\n", element);
+}
+
+/**
+ * Prints the current state of the swap file.
+ */
+template <int PAGE_SIZE, int NUM_OF_FRAMES, int TEXT_SIZE, int DATA_SIZE, int BSS_SIZE, int HEAP_STACK_SIZE>
+void static_sim_mem<PAGE_SIZE, NUM_OF_FRAMES, TEXT_SIZE, DATA_SIZE, BSS_SIZE, HEAP_STACK_SIZE>::print_swap()
+{
+    char str[PAGE_SIZE];
+    errors.flush();
+    printf("\n Swap memory\n");
+    for (int slot = 0; slot < SWAP_SIZE; slot++)
+    {
+        if (pread(swapfile_fd, str, PAGE_SIZE, (off_t) slot * PAGE_SIZE) != PAGE_SIZE)
+            break;
+
+        for (int i = 0; i < PAGE_SIZE; i++)
+            printf("%d - [%c]\t", i, str[i]);
+        printf("\n");
+    }
+}
+
+/**
+ * Prints the current state of the page table.
+ */
+template <int PAGE_SIZE, int NUM_OF_FRAMES, int TEXT_SIZE, int DATA_SIZE, int BSS_SIZE, int HEAP_STACK_SIZE>
+void static_sim_mem<PAGE_SIZE, NUM_OF_FRAMES, TEXT_SIZE, DATA_SIZE, BSS_SIZE, HEAP_STACK_SIZE>::print_page_table()
+{
+    errors.flush();
+    for (int outer = 0; outer < OUTER_TABLE_SIZE; outer++)
+    {
+        printf("Valid\t Dirty\t Frame\t Swap index\n");
+        for (int inner = 0; inner < pages_in(outer); inner++)
+        {
+            const page_descriptor& pd = page_table[page_index(outer, inner)];
+            printf("[%d]\t[%d]\t[%d]\t[%d]\n", pd.valid, pd.dirty, pd.frame, pd.swap_index);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,85 @@
+#include "event_trace.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define DECODE_BATCH 4096 // Events read from the trace file at once
+
+
+/**
+ * Decodes a binary event trace written by sim_mem::enable_event_trace.
+ *
+ * Usage: trace_decoder <trace file> [--csv]
+ *
+ * Prints one event per line, either as aligned text or as CSV, followed by (for text output) the number
+ * of events of each type. Events the simulator dropped because its ring buffer was full are reported, on
+ * stderr for CSV output.
+ */
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || (argc == 3 && strcmp(argv[2], "--csv") != 0) || argc > 3)
+    {
+        fprintf(stderr, "Usage: %s <trace file> [--csv]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    bool csv = argc == 3;
+
+    FILE* file = fopen(argv[1], "rb");
+    if (file == nullptr)
+    {
+        perror("ERR\n");
+        return EXIT_FAILURE;
+    }
+
+    trace_header header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != TRACE_VERSION || header.event_size != sizeof(trace_event))
+    {
+        fprintf(stderr, "ERR: %s is not a supported trace file\n", argv[1]);
+        fclose(file);
+        return EXIT_FAILURE;
+    }
+
+    static trace_event events[DECODE_BATCH];
+    long counts[TRACE_EVENT_TYPE_COUNT] = {0};
+    size_t read_count;
+
+    if (csv)
+        printf("timestamp,event,segment,page,frame,swap_index\n");
+    else
+        printf("%-10s %-9s %-8s %-5s %-6s %s\n", "Time", "Event", "Segment", "Page", "Frame", "Swap index");
+
+    while ((read_count = fread(events, sizeof(trace_event), DECODE_BATCH, file)) > 0)
+    {
+        for (size_t i = 0; i < read_count; i++)
+        {
+            const trace_event& e = events[i];
+
+            if (e.type < TRACE_EVENT_TYPE_COUNT)
+                counts[e.type]++;
+
+            if (csv)
+                printf("%lld,%s,%d,%d,%d,%d\n", (long long) e.timestamp, trace_event_name(e.type),
+                       e.segment, e.page, e.frame, e.swap_index);
+            else
+                printf("%-10lld %-9s %-8d %-5d %-6d %d\n", (long long) e.timestamp, trace_event_name(e.type),
+                       e.segment, e.page, e.frame, e.swap_index);
+        }
+    }
+
+    if (!csv)
+    {
+        printf("\n");
+        for (int i = 0; i < TRACE_EVENT_TYPE_COUNT; i++)
+            printf("%-9s %ld\n", trace_event_name(i), counts[i]);
+        printf("%-9s %lld\n", "dropped", (long long) header.dropped);
+    }
+    else if (header.dropped > 0)
+        fprintf(stderr, "WARNING: %lld events were dropped, the trace is incomplete\n", (long long) header.dropped);
+
+    fclose(file);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,345 @@
+#include "workload.h"
+
+#include <cstring>
+
+/**
+ * Creates the parameters of a workload, with the default value of every pattern-specific parameter.
+ *
+ * @param pattern: The access pattern.
+ * @param seed: Seed of the generator.
+ *
+ * @return: The parameters.
+ */
+workload_config make_workload_config(workload_pattern pattern, unsigned long seed)
+{
+    workload_config config;
+    config.pattern = pattern;
+    config.seed = seed;
+    config.read_ratio = WORKLOAD_READ_RATIO;
+    config.stride = WORKLOAD_STRIDE;
+    config.zipf_exponent = WORKLOAD_ZIPF_EXPONENT;
+    config.working_set = WORKLOAD_WORKING_SET;
+    config.phase_length = WORKLOAD_PHASE_LENGTH;
+    return config;
+}
+
+/**
+ * Returns the name of an access pattern.
+ *
+ * @param pattern: The access pattern.
+ *
+ * @return: A constant string naming the pattern.
+ */
+const char* workload_pattern_name(workload_pattern pattern)
+{
+    switch (pattern)
+    {
+        case WORKLOAD_SEQUENTIAL:
+            return "sequential";
+        case WORKLOAD_STRIDED:
+            return "strided";
+        case WORKLOAD_UNIFORM:
+            return "uniform";
+        case WORKLOAD_ZIPF:
+            return "zipf";
+        case WORKLOAD_PHASED:
+            return "phased";
+        case WORKLOAD_STACK:
+            return "stack";
+        default:
+            return "unknown";
+    }
+}
+
+/**
+ * Finds the access pattern with a given name.
+ *
+ * @param name: The name, as returned by workload_pattern_name.
+ *
+ * @return: The access pattern, or -1 if no pattern has this name.
+ */
+int workload_pattern_from_name(const char* name)
+{
+    for (int i = 0; i < WORKLOAD_PATTERN_COUNT; i++)
+        if (strcmp(name, workload_pattern_name((workload_pattern) i)) == 0)
+            return i;
+
+    return -1;
+}
+
+/**
+ * Constructor. Prepares the generator for the given segment layout and starts it at its first request.
+ * The simulator only maps whole pages, so the bytes of a segment past its last whole page are never used.
+ *
+ * @param config: Parameters of the workload.
+ * @param text_size: Size of the text segment.
+ * @param data_size: Size of the data segment.
+ * @param bss_size: Size of the BSS segment.
+ * @param heap_stack_size: Size of the heap/stack.
+ * @param page_size: Size of each page.
+ */
+workload_generator::workload_generator(const workload_config& config, int text_size, int data_size, int bss_size, int heap_stack_size, int page_size)
+{
+    this->config = config;
+    this->segment_size[0] = text_size / page_size * page_size;
+    this->segment_size[1] = data_size / page_size * page_size;
+    this->segment_size[2] = bss_size / page_size * page_size;
+    this->segment_size[3] = heap_stack_size / page_size * page_size;
+    this->page_size = page_size;
+    this->total_size = segment_size[0] + segment_size[1] + segment_size[2] + segment_size[3];
+    this->total_pages = total_size / page_size;
+    this->page_rank = new int[total_pages];
+    this->zipf_cdf = new double[total_pages];
+    this->heap_stored = new bool[segment_size[3] / page_size + 1];
+
+    // The popularity of rank k is proportional to 1 / k^exponent
+    double sum = 0;
+    for (int k = 0; k < total_pages; k++)
+    {
+        sum += 1.0 / std::pow(k + 1, config.zipf_exponent);
+        zipf_cdf[k] = sum;
+    }
+    for (int k = 0; k < total_pages; k++)
+        zipf_cdf[k] /= sum;
+
+    reset();
+}
+
+/**
+ * Destructor.
+ */
+workload_generator::~workload_generator()
+{
+    delete[] page_rank;
+    delete[] zipf_cdf;
+    delete[] heap_stored;
+}
+
+/**
+ * Restarts the workload: the following requests are the same as those generated right after construction.
+ */
+void workload_generator::reset()
+{
+    random.seed(config.seed);
+    issued = 0;
+    cursor = 0;
+    phase_base = 0;
+    stack_top = 0;
+
+    for (int i = 0; i <= segment_size[3] / page_size; i++)
+        heap_stored[i] = false;
+
+    // Scatter the hot pages over the segments with a seeded shuffle
+    for (int i = 0; i < total_pages; i++)
+        page_rank[i] = i;
+    for (int i = total_pages - 1; i > 0; i--)
+    {
+        int j = random_int(i + 1);
+        int temp = page_rank[i];
+        page_rank[i] = page_rank[j];
+        page_rank[j] = temp;
+    }
+}
+
+/**
+ * Generates the next request of the workload.
+ *
+ * @param access: Where to store the request.
+ */
+void workload_generator::next(trace_access* access)
+{
+    // Uniform in [0, 1), computed here rather than with a standard distribution so that workloads are the same on every platform
+    double chance = (double) (random() >> 11) / 9007199254740992.0;
+    bool load = chance < config.read_ratio;
+    int address;
+
+    switch (config.pattern)
+    {
+        case WORKLOAD_SEQUENTIAL:
+            address = byte_address(cursor++);
+            break;
+
+        case WORKLOAD_STRIDED:
+            address = byte_address(cursor);
+            cursor = (cursor + config.stride) % total_size;
+            break;
+
+        case WORKLOAD_ZIPF:
+        {
+            double target = (double) (random() >> 11) / 9007199254740992.0;
+            int low = 0, high = total_pages - 1;
+
+            // First rank whose cumulative probability reaches the target
+            while (low < high)
+            {
+                int middle = (low + high) / 2;
+                if (zipf_cdf[middle] < target)
+                    low = middle + 1;
+                else
+                    high = middle;
+            }
+
+            address = page_address(page_rank[low], random_int(page_size));
+            break;
+        }
+
+        case WORKLOAD_PHASED:
+            if (issued > 0 && issued % config.phase_length == 0)
+                phase_base = random_int(total_pages);
+
+            address = page_address((phase_base + random_int(config.working_set)) % total_pages, random_int(page_size));
+            break;
+
+        case WORKLOAD_STACK:
+            if (segment_size[3] > 0)
+            {
+                // Shrink (load the top byte) or grow (store a new top byte)
+                if (stack_top == segment_size[3] || (stack_top > 0 && load))
+                {
+                    stack_top--;
+                    address = (3 << SEGMENT_SHIFT) | stack_top;
+                    load = true;
+                }
+                else
+                {
+                    address = (3 << SEGMENT_SHIFT) | stack_top;
+                    stack_top++;
+                    load = false;
+                }
+                break;
+            }
+
+            // Without a heap/stack, fall back to uniform requests
+            address = byte_address(random_int(total_size));
+            break;
+
+        default:
+            address = byte_address(random_int(total_size));
+            break;
+    }
+
+    finish(access, address, load);
+    issued++;
+}
+
+/**
+ * Runs requests straight through a simulator, without any I/O of their own.
+ *
+ * @param mem: The simulator.
+ * @param count: Number of requests.
+ *
+ * @return: The number of requests that failed.
+ */
+long workload_generator::run(sim_mem* mem, long count)
+{
+    trace_access access;
+    long failures = 0;
+    char value;
+
+    for (long i = 0; i < count; i++)
+    {
+        next(&access);
+
+        sim_error result = access.op == TRACE_STORE ? mem->try_store(access.address, access.value)
+                                                    : mem->try_load(access.address, &value);
+        if (result != SIM_OK)
+            failures++;
+    }
+
+    return failures;
+}
+
+/**
+ * Writes requests to a text access trace, to be replayed later (see min_trace).
+ *
+ * @param file: The trace file.
+ * @param count: Number of requests.
+ *
+ * @return: True if all requests were written, false otherwise.
+ */
+bool workload_generator::write_trace(FILE* file, long count)
+{
+    trace_access access;
+
+    for (long i = 0; i < count; i++)
+    {
+        next(&access);
+        if (!write_access(file, &access))
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Computes the logical address of a byte of a page.
+ *
+ * @param page: Index of the page over all segments together.
+ * @param offset: Offset within the page.
+ *
+ * @return: The logical address.
+ */
+int workload_generator::page_address(int page, int offset) const
+{
+    return byte_address((long) page * page_size + offset);
+}
+
+/**
+ * Computes the logical address of a byte of all segments together, one after another.
+ *
+ * @param position: Position of the byte, wrapped around the total size.
+ *
+ * @return: The logical address.
+ */
+int workload_generator::byte_address(long position) const
+{
+    int rest = (int) (position % total_size);
+    int outer = 0;
+
+    while (rest >= segment_size[outer])
+    {
+        rest -= segment_size[outer];
+        outer++;
+    }
+
+    return (outer << SEGMENT_SHIFT) | rest;
+}
+
+/**
+ * @param bound: Exclusive upper bound, positive.
+ *
+ * @return: A random integer in [0, bound).
+ */
+int workload_generator::random_int(int bound)
+{
+    return (int) (random() % (unsigned long) bound);
+}
+
+/**
+ * Fills in a request, keeping it legal: text pages are only loaded, and a heap/stack page is stored to
+ * before it is ever loaded.
+ *
+ * @param access: Where to store the request.
+ * @param address: The logical address.
+ * @param load: True for a load, false for a store.
+ */
+void workload_generator::finish(trace_access* access, int address, bool load)
+{
+    int outer = address >> SEGMENT_SHIFT;
+
+    if (outer == 0)
+        load = true;
+
+    if (outer == 3)
+    {
+        int page = (address & ((1 << SEGMENT_SHIFT) - 1)) / page_size;
+        if (!heap_stored[page])
+            load = false;
+        heap_stored[page] = true;
+    }
+
+    memset(access, 0, sizeof(trace_access));
+    access->address = address;
+    access->op = load ? TRACE_LOAD : TRACE_STORE;
+    access->value = load ? '\0' : (char) ('a' + random_int(26));
+}
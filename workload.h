@@ -0,0 +1,81 @@
+#ifndef EX4_WORKLOAD_H
+#define EX4_WORKLOAD_H
+
+// Required libraries and headers
+#include <random>
+#include "sim_mem.h"
+#include "access_trace.h"
+
+// Default parameters of generated workloads
+#define WORKLOAD_READ_RATIO 0.7     // Fraction of the requests that are loads
+#define WORKLOAD_STRIDE 16          // Distance between the addresses of a strided scan
+#define WORKLOAD_ZIPF_EXPONENT 1.0  // Skew of the Zipfian page popularity
+#define WORKLOAD_WORKING_SET 4      // Pages in the working set of a phase
+#define WORKLOAD_PHASE_LENGTH 1000  // Requests before the working set moves
+
+
+// Access patterns of generated workloads
+typedef enum workload_pattern
+{
+    WORKLOAD_SEQUENTIAL = 0,  // Scan all segments byte after byte, wrapping around
+    WORKLOAD_STRIDED,         // Scan all segments with a fixed stride, wrapping around
+    WORKLOAD_UNIFORM,         // Uniformly random addresses
+    WORKLOAD_ZIPF,            // Pages chosen with a Zipfian popularity, a small hot set gets most requests
+    WORKLOAD_PHASED,          // Uniform inside a small working set that moves every phase
+    WORKLOAD_STACK,           // The heap/stack grows (stores) and shrinks (loads) like a stack
+    WORKLOAD_PATTERN_COUNT
+} workload_pattern;
+
+// Parameters of a generated workload
+typedef struct workload_config
+{
+    workload_pattern pattern;  // The access pattern
+    unsigned long seed;        // Seed of the generator, equal seeds give equal workloads
+    double read_ratio;         // Fraction of the requests that are loads (for WORKLOAD_STACK: chance to shrink)
+    int stride;                // Distance between the addresses of WORKLOAD_STRIDED
+    double zipf_exponent;      // Skew of WORKLOAD_ZIPF
+    int working_set;           // Pages in the working set of WORKLOAD_PHASED
+    long phase_length;         // Requests in a phase of WORKLOAD_PHASED
+} workload_config;
+
+workload_config make_workload_config(workload_pattern pattern, unsigned long seed);  // Config with default parameters
+const char* workload_pattern_name(workload_pattern pattern);  // Name of an access pattern
+int workload_pattern_from_name(const char* name);  // Access pattern of a name, -1 if unknown
+
+
+// Generates a reproducible stream of load/store requests over the text, data, bss and heap/stack segments.
+// Requests are always legal: text pages are only loaded, and heap/stack pages are only loaded once stored to.
+class workload_generator {
+
+    workload_config config;    // Parameters of the workload
+    int segment_size[OUTER_TABLE_SIZE]; // Usable size of each segment, in whole pages
+    int page_size;             // Size of a single page
+    int total_size;            // Size of all segments together
+    int total_pages;           // Pages of all segments together
+    std::mt19937_64 random;    // Random number generator
+    long issued;               // Requests generated so far
+    long cursor;               // Position of the scans, in bytes of all segments together
+    int phase_base;            // First page of the current working set
+    int stack_top;             // Bytes in use in the heap/stack
+    int* page_rank;            // Page of each popularity rank (WORKLOAD_ZIPF)
+    double* zipf_cdf;          // Cumulative probability of each popularity rank (WORKLOAD_ZIPF)
+    bool* heap_stored;         // Has each heap/stack page been stored to?
+
+public:
+    workload_generator(const workload_config& config, int text_size, int data_size, int bss_size, int heap_stack_size, int page_size);  // Constructor
+    ~workload_generator();  // Destructor
+    workload_generator(const workload_generator&) = delete;
+    workload_generator& operator=(const workload_generator&) = delete;
+    void reset();  // Restart the workload from its first request
+    void next(trace_access* access);  // Generate the next request
+    long run(sim_mem* mem, long count);  // Run requests straight through a simulator
+    bool write_trace(FILE* file, long count);  // Write requests to a text access trace
+
+private:
+    int page_address(int page, int offset) const;  // Logical address of a byte of a page
+    int byte_address(long position) const;  // Logical address of a byte of all segments together
+    int random_int(int bound);  // Uniformly random integer in [0, bound)
+    void finish(trace_access* access, int address, bool load);  // Fill in a request, keeping it legal
+};
+
+#endif
@@ -0,0 +1,50 @@
+#include "workload.h"
+
+
+/**
+ * Writes a generated workload to stdout as a text access trace.
+ *
+ * Usage: workload_gen <pattern> <requests> <seed> <text size> <data size> <bss size> <heap/stack size>
+ *                     <page size> [read ratio]
+ *
+ * Patterns: sequential, strided, uniform, zipf, phased, stack.
+ */
+int main(int argc, char* argv[])
+{
+    int pattern = argc >= 2 ? workload_pattern_from_name(argv[1]) : -1;
+
+    if ((argc != 9 && argc != 10) || pattern == -1)
+    {
+        fprintf(stderr, "Usage: %s <pattern> <requests> <seed> <text size> <data size> <bss size> "
+                        "<heap/stack size> <page size> [read ratio]\n", argv[0]);
+        fprintf(stderr, "Patterns:");
+        for (int i = 0; i < WORKLOAD_PATTERN_COUNT; i++)
+            fprintf(stderr, " %s", workload_pattern_name((workload_pattern) i));
+        fprintf(stderr, "\n");
+        return EXIT_FAILURE;
+    }
+
+    workload_config config = make_workload_config((workload_pattern) pattern, strtoul(argv[3], nullptr, 10));
+    if (argc == 10)
+        config.read_ratio = atof(argv[9]);
+
+    // Only whole pages are used, so at least one segment must hold a page
+    int page_size = atoi(argv[8]);
+    if (page_size <= 0 || (atoi(argv[4]) / page_size + atoi(argv[5]) / page_size +
+                           atoi(argv[6]) / page_size + atoi(argv[7]) / page_size) <= 0)
+    {
+        fprintf(stderr, "ERR no segment holds a whole page\n");
+        return EXIT_FAILURE;
+    }
+
+    workload_generator generator(config, atoi(argv[4]), atoi(argv[5]), atoi(argv[6]), atoi(argv[7]), page_size);
+
+    printf("# %s workload, seed %lu, read ratio %.2f\n", argv[1], config.seed, config.read_ratio);
+    if (!generator.write_trace(stdout, atol(argv[2])))
+    {
+        perror("ERR\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}